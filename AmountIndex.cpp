@@ -0,0 +1,168 @@
+#include "AmountIndex.h"
+#include <algorithm>
+#include <cmath>
+
+AmountIndex amountIndex;
+
+static bool EntryBefore(const AmountEntry& a, const AmountEntry& b) {
+    return a.amount != b.amount ? a.amount < b.amount : a.seq < b.seq;
+}
+
+static AmountEntry MakeEntry(size_t row) {
+    return { ledger.Amounts()[row], ledger.Sequences()[row], static_cast<uint32_t>(row) };
+}
+
+// AmountOrderedRows
+std::span<const AmountEntry> AmountOrderedRows::Range(double minAmount, double maxAmount) const {
+    auto first = std::lower_bound(entries.begin(), entries.end(), minAmount,
+        [](const AmountEntry& entry, double amount) { return entry.amount < amount; });
+    auto last = std::upper_bound(first, entries.end(), maxAmount,
+        [](double amount, const AmountEntry& entry) { return amount < entry.amount; });
+    return std::span<const AmountEntry>(entries.data() + (first - entries.begin()), last - first);
+}
+
+std::span<const AmountEntry> AmountOrderedRows::Smallest(size_t n) const {
+    return std::span<const AmountEntry>(entries.data(), std::min(n, entries.size()));
+}
+
+std::span<const AmountEntry> AmountOrderedRows::Largest(size_t n) const {
+    n = std::min(n, entries.size());
+    return std::span<const AmountEntry>(entries.data() + entries.size() - n, n);
+}
+
+double AmountOrderedRows::Mean() const {
+    return entries.empty() ? 0.0 : sum / entries.size();
+}
+
+double AmountOrderedRows::StandardDeviation() const {
+    if (entries.empty()) return 0.0;
+    double mean = Mean();
+    // Rounding in the running sums can leave a tiny negative variance
+    return std::sqrt(std::max(0.0, sumOfSquares / entries.size() - mean * mean));
+}
+
+void AmountOrderedRows::Clear() {
+    entries.clear();
+    sum = 0.0;
+    sumOfSquares = 0.0;
+}
+
+void AmountOrderedRows::Append(size_t row) {
+    entries.push_back(MakeEntry(row));
+}
+
+void AmountOrderedRows::Sort() {
+    std::sort(entries.begin(), entries.end(), EntryBefore);
+    Resum();
+}
+
+void AmountOrderedRows::Insert(size_t row) {
+    AmountEntry entry = MakeEntry(row);
+    entries.insert(std::upper_bound(entries.begin(), entries.end(), entry, EntryBefore), entry);
+    sum += entry.amount;
+    sumOfSquares += entry.amount * entry.amount;
+}
+
+void AmountOrderedRows::Erase(size_t row) {
+    auto it = Find(row);
+    if (it != entries.end()) {
+        sum -= it->amount;
+        sumOfSquares -= it->amount * it->amount;
+        entries.erase(it);
+    }
+}
+
+void AmountOrderedRows::Renumber(size_t from, size_t to) {
+    auto it = Find(from);
+    if (it != entries.end()) {
+        it->row = static_cast<uint32_t>(to);
+    }
+}
+
+void AmountOrderedRows::EraseDead() {
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+        [](const AmountEntry& entry) { return !ledger.IsLive(entry.row); }), entries.end());
+    Resum();
+}
+
+std::vector<AmountEntry>::iterator AmountOrderedRows::Find(size_t row) {
+    AmountEntry key = MakeEntry(row);
+    auto it = std::lower_bound(entries.begin(), entries.end(), key, EntryBefore);
+    return (it != entries.end() && it->seq == key.seq) ? it : entries.end();
+}
+
+// Recomputed after bulk changes, which also clears accumulated rounding
+void AmountOrderedRows::Resum() {
+    sum = 0.0;
+    sumOfSquares = 0.0;
+    for (const auto& entry : entries) {
+        sum += entry.amount;
+        sumOfSquares += entry.amount * entry.amount;
+    }
+}
+
+// AmountIndex
+const AmountOrderedRows& AmountIndex::Rows(bool income, SymbolId user, SymbolId category) const {
+    static const AmountOrderedRows none;
+    const auto& byKey = lists[income ? 1 : 0];
+    auto it = byKey.find(Key(user, category));
+    return it != byKey.end() ? it->second : none;
+}
+
+std::vector<SymbolId> AmountIndex::Categories(bool income, SymbolId user) const {
+    std::vector<SymbolId> result;
+    for (const auto& [key, rows] : lists[income ? 1 : 0]) {
+        SymbolId category = static_cast<SymbolId>(key);
+        if ((key >> 32) == user && category != ALL_SYMBOLS && !rows.empty()) result.push_back(category);
+    }
+    return result;
+}
+
+template <typename Fn>
+void AmountIndex::ForEachList(size_t row, Fn fn) {
+    auto& byKey = lists[(ledger.Flags()[row] & LEDGER_INCOME) ? 1 : 0];
+    SymbolId user = ledger.Users()[row];
+    SymbolId category = ledger.Categories()[row];
+
+    fn(byKey[Key(ALL_SYMBOLS, ALL_SYMBOLS)]);
+    fn(byKey[Key(user, ALL_SYMBOLS)]);
+    fn(byKey[Key(ALL_SYMBOLS, category)]);
+    fn(byKey[Key(user, category)]);
+}
+
+void AmountIndex::OnRebuilt() {
+    OnCleared();
+    ledger.ForEachRow([this](size_t row) {
+        ForEachList(row, [row](AmountOrderedRows& rows) { rows.Append(row); });
+    });
+    for (auto& byKey : lists) {
+        for (auto& pair : byKey) pair.second.Sort();
+    }
+}
+
+void AmountIndex::OnCleared() {
+    for (auto& byKey : lists) byKey.clear();
+}
+
+void AmountIndex::OnRowAdded(size_t row) {
+    ForEachList(row, [row](AmountOrderedRows& rows) { rows.Insert(row); });
+}
+
+void AmountIndex::OnRowRemoving(size_t row) {
+    ForEachList(row, [row](AmountOrderedRows& rows) { rows.Erase(row); });
+}
+
+void AmountIndex::OnRowsRemoved(std::span<const uint32_t> rows) {
+    // Each list that lost rows gets one pass
+    std::vector<AmountOrderedRows*> touched;
+    for (uint32_t row : rows) {
+        ForEachList(row, [&touched](AmountOrderedRows& list) {
+            if (std::find(touched.begin(), touched.end(), &list) == touched.end()) touched.push_back(&list);
+        });
+    }
+    for (auto* list : touched) list->EraseDead();
+}
+
+void AmountIndex::OnRowMoved(size_t from, size_t to) {
+    ForEachList(from, [from, to](AmountOrderedRows& rows) { rows.Renumber(from, to); });
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include "Ledger.h"
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+// Ledger row position in (amount, sequence) order
+struct AmountEntry {
+    double amount;
+    uint32_t seq;
+    uint32_t row;   // Current ledger row
+};
+
+// Ledger rows kept sorted by (amount, sequence), with a running sum and sum
+// of squares for the mean and spread. An amount range or the N largest /
+// smallest rows are a binary search and a contiguous walk.
+class AmountOrderedRows {
+public:
+    using const_iterator = std::vector<AmountEntry>::const_iterator;
+    using const_reverse_iterator = std::vector<AmountEntry>::const_reverse_iterator;
+
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+    const_reverse_iterator rbegin() const { return entries.rbegin(); }   // Largest first
+    const_reverse_iterator rend() const { return entries.rend(); }
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+
+    // Entries with minAmount <= amount <= maxAmount, smallest first
+    std::span<const AmountEntry> Range(double minAmount, double maxAmount) const;
+
+    // The n smallest / largest entries, smallest first in both cases
+    std::span<const AmountEntry> Smallest(size_t n) const;
+    std::span<const AmountEntry> Largest(size_t n) const;
+
+    double Mean() const;
+    double StandardDeviation() const;   // Population
+
+    void Clear();
+    void Append(size_t row);    // Unordered bulk add; call Sort() when done
+    void Sort();
+    void Insert(size_t row);
+    void Erase(size_t row);
+    void Renumber(size_t from, size_t to);
+    void EraseDead();           // Drops entries whose row is no longer live
+
+private:
+    std::vector<AmountEntry>::iterator Find(size_t row);
+    void Resum();
+
+    std::vector<AmountEntry> entries;
+    double sum = 0.0;
+    double sumOfSquares = 0.0;
+};
+
+// Amount-ordered row lists per row kind, scoped to all rows, one user, one
+// category (source for incomes) or one user's category
+class AmountIndex : public LedgerIndex {
+public:
+    // Pass ALL_SYMBOLS for an open user or category. Valid until the next ledger change.
+    const AmountOrderedRows& Rows(bool income, SymbolId user = ALL_SYMBOLS, SymbolId category = ALL_SYMBOLS) const;
+
+    // Categories the user has rows of this kind in
+    std::vector<SymbolId> Categories(bool income, SymbolId user) const;
+
+    void OnRebuilt() override;
+    void OnCleared() override;
+    void OnRowAdded(size_t row) override;
+    void OnRowRemoving(size_t row) override;
+    void OnRowsRemoved(std::span<const uint32_t> rows) override;
+    void OnRowMoved(size_t from, size_t to) override;
+
+private:
+    static uint64_t Key(SymbolId user, SymbolId category) { return (uint64_t(user) << 32) | category; }
+
+    // The four lists a row belongs to
+    template <typename Fn>
+    void ForEachList(size_t row, Fn fn);
+
+    std::unordered_map<uint64_t, AmountOrderedRows> lists[2];   // By kind: expenses, incomes
+};
+
+extern AmountIndex amountIndex;
@@ -5,12 +5,23 @@
 #include "DatabaseManager.h"
 #include "DataStructures.h"
 #include "Utils.h"
+#include "Ledger.h"
+#include "LedgerTimeline.h"
+#include "AmountIndex.h"
+#include "AnomalyIndex.h"
+#include "RollupCube.h"
+#include "QuantileIndex.h"
+#include "StatsKernels.h"
+#include "ForecastEngine.h"
+#include "CurrencyManager.h"
 #include <algorithm>
 #include <numeric>
 #include <cmath>
+#include <limits>
 #include <iomanip>
 #include <sstream>
 #include <set>
+#include <unordered_map>
 #include <sstream>     // For 'ss', 'stream'
 #include <iostream>    // For 'std::cout', 'out'
 #include <chrono>      // For 'now' (if using time functions)
@@ -43,44 +54,9 @@ std::map<int, double> Analytics::GetSpendingByDayOfWeek(const std::wstring& user
 
 // Dialog functions
 // Add these declarations to make the global functions visible
-std::map<std::wstring, double> GetSpendingTrends(const std::wstring& userId, const std::wstring& period) {
-    std::map<std::wstring, double> trends;
-    trends[L"January"] = 1500.0;
-    trends[L"February"] = 1800.0;
-    trends[L"March"] = 1200.0;
-    return trends;
-}
+extern std::vector<SpendingTrend> GetSpendingTrends(const std::wstring& userId, const std::wstring& period);
 extern std::vector<CategoryAnalytics> GetCategoryAnalytics(const std::wstring& userId, const DateRange& range);
 extern std::map<std::wstring, double> GetCategoryTotals(const std::wstring& userId, const DateRange& range);
-// Add this in Analytics.cpp before they're used
-namespace AdvancedAnalyticsHelpers {
-    std::pair<double, double> LinearRegression(const std::vector<double>& x, const std::vector<double>& y) {
-        if (x.empty() || y.empty() || x.size() != y.size()) return { 0, 0 };
-
-        const size_t n = x.size();
-        double sumX = 0, sumY = 0, sumXY = 0, sumX2 = 0;
-
-        for (size_t i = 0; i < n; ++i) {
-            sumX += x[i];
-            sumY += y[i];
-            sumXY += x[i] * y[i];
-            sumX2 += x[i] * x[i];
-        }
-
-        double denominator = n * sumX2 - sumX * sumX;
-        if (denominator == 0) return { 0, 0 };
-
-        double slope = (n * sumXY - sumX * sumY) / denominator;
-        double intercept = (sumY - slope * sumX) / n;
-
-        return { slope, intercept };
-    }
-
-    double PredictValue(const std::pair<double, double>& coeffs, double x) {
-        return coeffs.first * x + coeffs.second;
-    }
-}
-
 // Add these helper functions in Analytics.cpp (before they're used)
 
 
@@ -105,32 +81,96 @@ void Analytics::ShowForecastDialog(HWND parent) {
 }
 
 
-double Analytics::GetTotalIncome(const std::wstring& userId, const DateRange& range) {
+// The currency the user's figures are reported in; looked up once per query
+// instead of once per row
+static CurrencyType GetReportingCurrency(const std::wstring& userId) {
+    User* user = UserManager::GetUserByUsername(userId);
+    return user ? user->defaultCurrency : CurrencyType::USD;
+}
+
+// Rows gathered per batch conversion in SumLedgerAmounts
+const size_t CONVERT_BATCH = 256;
+
+// Sums converted amounts of one row kind over the user's rows in the range,
+// found by binary search in the user's timeline. Matching amounts are
+// gathered into small contiguous batches for the conversion kernel, each
+// converted at the rate on its transaction date.
+static double SumLedgerAmounts(const std::wstring& userId, const DateRange& range, uint8_t kind) {
+    SymbolId userSymbol = SymbolTable::Find(userId);
+    if (userSymbol == INVALID_SYMBOL) return 0.0;
+
+    CurrencyType target = GetReportingCurrency(userId);
+    DayRange days = ToDayRange(range);
+
+    auto amountColumn = ledger.Amounts();
+    auto currencyColumn = ledger.Currencies();
+    auto flagColumn = ledger.Flags();
+
+    double amounts[CONVERT_BATCH];
+    uint8_t currencies[CONVERT_BATCH];
+    int32_t transactionDays[CONVERT_BATCH];
+    size_t pending = 0;
+
     double total = 0.0;
-    for (const auto& income : incomes) {
-        if (income.userId == userId && IsDateInRange(income.date, range)) {
-            total += ConvertCurrency(income.amount, income.currency,
-                UserManager::GetUserByUsername(userId)->defaultCurrency);
+    for (const auto& entry : userTimeline.Range(userSymbol, days)) {
+        if ((flagColumn[entry.row] & LEDGER_INCOME) != kind) continue;
+
+        amounts[pending] = amountColumn[entry.row];
+        currencies[pending] = currencyColumn[entry.row];
+        transactionDays[pending] = entry.day;
+        if (++pending == CONVERT_BATCH) {
+            total += CurrencyManager::SumConvertedOn(amounts, currencies, transactionDays, target);
+            pending = 0;
         }
     }
+    total += CurrencyManager::SumConvertedOn(std::span(amounts, pending), std::span(currencies, pending),
+        std::span(transactionDays, pending), target);
     return total;
 }
 
+double Analytics::GetTotalIncome(const std::wstring& userId, const DateRange& range) {
+    return SumLedgerAmounts(userId, range, LEDGER_INCOME);
+}
+
 double Analytics::GetTotalExpenses(const std::wstring& userId, const DateRange& range) {
-    double total = 0.0;
-    for (const auto& expense : expenses) {
-        if (expense.userId == userId && IsDateInRange(expense.date, range)) {
-            total += ConvertCurrency(expense.amount, expense.currency,
-                UserManager::GetUserByUsername(userId)->defaultCurrency);
-        }
-    }
-    return total;
+    return SumLedgerAmounts(userId, range, 0);
 }
 
 double Analytics::GetBalance(const std::wstring& userId, const DateRange& range) {
     return GetTotalIncome(userId, range) - GetTotalExpenses(userId, range);
 }
 
+// Dashboard metrics are read on every paint and refresh tick. Each entry
+// remembers the ledger version, rates version and currency it was computed
+// for, so any change invalidates it without explicit notification.
+struct DashboardCacheEntry {
+    uint64_t ledgerVersion;
+    uint64_t ratesVersion;
+    CurrencyType currency;
+    DashboardMetrics metrics;
+};
+
+static std::unordered_map<std::wstring, DashboardCacheEntry> dashboardCache;
+
+DashboardMetrics Analytics::GetDashboardMetrics(const std::wstring& userId) {
+    CurrencyType currency = GetReportingCurrency(userId);
+
+    auto it = dashboardCache.find(userId);
+    if (it != dashboardCache.end() && it->second.ledgerVersion == ledger.Version()
+        && it->second.ratesVersion == CurrencyManager::RatesVersion() && it->second.currency == currency) {
+        return it->second.metrics;
+    }
+
+    DashboardMetrics metrics;
+    metrics.totalIncome = GetTotalIncome(userId);
+    metrics.totalExpenses = GetTotalExpenses(userId);
+    metrics.balance = metrics.totalIncome - metrics.totalExpenses;
+    metrics.savingsRate = metrics.totalIncome > 0 ? metrics.balance / metrics.totalIncome * 100 : 0.0;
+
+    dashboardCache[userId] = { ledger.Version(), CurrencyManager::RatesVersion(), currency, metrics };
+    return metrics;
+}
+
 double Analytics::GetAverageMonthlyIncome(const std::wstring& userId, int months) {
     auto monthlyData = GetMonthlyData(userId, months);
     if (monthlyData.empty()) return 0.0;
@@ -155,68 +195,44 @@ double Analytics::GetAverageMonthlyExpenses(const std::wstring& userId, int mont
 
 // Trend analysis
 std::vector<SpendingTrend> Analytics::GetSpendingTrends(const std::wstring& userId, const std::wstring& period) {
-    return Analytics::GetSpendingTrends(userId, period); 
+    return ::GetSpendingTrends(userId, period); // Use global function
 }
 
 std::vector<MonthlyFinancialData> Analytics::GetMonthlyData(const std::wstring& userId, int months) {
-    std::map<std::wstring, MonthlyFinancialData> monthlyMap;
-
-    // Process expenses
-    for (const auto& expense : expenses) {
-        if (expense.userId != userId) continue;
+    SymbolId userSymbol = SymbolTable::Find(userId);
+    if (userSymbol == INVALID_SYMBOL) return {};
 
-        std::wstring monthKey = expense.date.substr(0, 7); // YYYY-MM
-
-        if (monthlyMap.find(monthKey) == monthlyMap.end()) {
-            monthlyMap[monthKey] = MonthlyFinancialData();
-            monthlyMap[monthKey].month = monthKey;
-        }
-
-        double convertedAmount = ConvertCurrency(expense.amount, expense.currency,
-            UserManager::GetUserByUsername(userId)->defaultCurrency);
-
-        monthlyMap[monthKey].totalExpenses += convertedAmount;
-        monthlyMap[monthKey].categorySpending[expense.category] += convertedAmount;
-        monthlyMap[monthKey].transactionCount++;
-    }
-
-    // Process incomes
-    for (const auto& income : incomes) {
-        if (income.userId != userId) continue;
-
-        std::wstring monthKey = income.date.substr(0, 7); // YYYY-MM
-
-        if (monthlyMap.find(monthKey) == monthlyMap.end()) {
-            monthlyMap[monthKey] = MonthlyFinancialData();
-            monthlyMap[monthKey].month = monthKey;
-        }
-
-        double convertedAmount = ConvertCurrency(income.amount, income.currency,
-            UserManager::GetUserByUsername(userId)->defaultCurrency);
-
-        monthlyMap[monthKey].totalIncome += convertedAmount;
-        monthlyMap[monthKey].transactionCount++;
-    }
-
-    // Calculate balances
-    for (auto& pair : monthlyMap) {
-        pair.second.balance = pair.second.totalIncome - pair.second.totalExpenses;
-    }
+    return GetMonthlyData(userSymbol, GetReportingCurrency(userId), months);
+}
 
-    // Convert to vector and sort
+std::vector<MonthlyFinancialData> Analytics::GetMonthlyData(SymbolId userSymbol, CurrencyType target, int months) {
     std::vector<MonthlyFinancialData> result;
-    for (const auto& pair : monthlyMap) {
-        result.push_back(pair.second);
-    }
-
-    std::sort(result.begin(), result.end(),
-        [](const MonthlyFinancialData& a, const MonthlyFinancialData& b) {
-            return a.month > b.month; // Most recent first
-        });
 
-    // Limit to requested number of months
-    if (result.size() > static_cast<size_t>(months)) {
-        result.resize(months);
+    // Most recent first, limited to the requested number of months. Each
+    // month is a few rollup cells, one per category and currency, so no
+    // transaction is read; undated rows have no month and are not counted.
+    // Cells hold sums, not rows, so a month is valued at its mid-month rates.
+    const auto& rollup = rollupCube.Months(userSymbol);
+    for (auto it = rollup.rbegin(); it != rollup.rend(); ++it) {
+        if (result.size() >= static_cast<size_t>(std::max(months, 0))) break;
+
+        MonthlyFinancialData data{};
+        data.month = MonthIndexToKey(it->first);
+        double factors[CURRENCY_TYPE_COUNT];
+        CurrencyManager::FactorsOn(target, MonthIndexToMidDay(it->first), factors);
+        for (const auto& cell : it->second) {
+            double convertedAmount = cell.sum * factors[cell.currency];
+            if (cell.income) {
+                data.totalIncome += convertedAmount;
+            }
+            else {
+                data.totalExpenses += convertedAmount;
+                data.categorySpending[std::wstring(SymbolTable::Resolve(cell.category))] += convertedAmount;
+            }
+            data.transactionCount += cell.count;
+        }
+        data.balance = data.totalIncome - data.totalExpenses;
+        result.push_back(std::move(data));
     }
 
     return result;
@@ -288,13 +304,46 @@ std::vector<std::wstring> Analytics::GetTopCategories(const std::wstring& userId
     return result;
 }
 
+// Largest first. Walks the user's expenses down from the largest amount, so
+// only rows down to the count-th one in the range are read.
+std::vector<Expense> Analytics::GetLargestExpenses(const std::wstring& userId, int count, const DateRange& range) {
+    std::vector<Expense> result;
+
+    SymbolId userSymbol = SymbolTable::Find(userId);
+    if (!userId.empty() && userSymbol == INVALID_SYMBOL) return result;
+
+    DayRange days = ToDayRange(range);
+    const auto& rows = amountIndex.Rows(false, userId.empty() ? ALL_SYMBOLS : userSymbol);
+    auto dayColumn = ledger.Days();
+
+    for (auto it = rows.rbegin(); it != rows.rend() && static_cast<int>(result.size()) < count; ++it) {
+        if (days.Contains(dayColumn[it->row])) result.push_back(ledger.Row(it->row).GetExpense());
+    }
+
+    return result;
+}
+
 double Analytics::GetCategoryGrowthRate(const std::wstring& userId, const std::wstring& category, int months) {
-    auto monthlyData = GetMonthlyData(userId, months);
+    SymbolId userSymbol = SymbolTable::Find(userId);
+    if (userSymbol == INVALID_SYMBOL) return 0.0;
+    SymbolId categorySymbol = SymbolTable::Find(category);
 
+    CurrencyType target = GetReportingCurrency(userId);
+
+    // The category's cells in the user's last months with rows, each month
+    // at its mid-month rates
     std::vector<double> categoryValues;
-    for (const auto& data : monthlyData) {
-        auto it = data.categorySpending.find(category);
-        categoryValues.push_back(it != data.categorySpending.end() ? it->second : 0.0);
+    const auto& rollup = rollupCube.Months(userSymbol);
+    for (auto it = rollup.rbegin(); it != rollup.rend(); ++it) {
+        if (categoryValues.size() >= static_cast<size_t>(std::max(months, 0))) break;
+
+        double factors[CURRENCY_TYPE_COUNT];
+        CurrencyManager::FactorsOn(target, MonthIndexToMidDay(it->first), factors);
+        double total = 0.0;
+        for (const auto& cell : it->second) {
+            if (!cell.income && cell.category == categorySymbol) total += cell.sum * factors[cell.currency];
+        }
+        categoryValues.push_back(total);
     }
 
     std::reverse(categoryValues.begin(), categoryValues.end()); // Chronological order
@@ -350,77 +399,18 @@ std::wstring Analytics::GetChangeDescription(double percentageChange) {
 }
 
 // Forecasting
+// Read from the cached seasonal models; see ForecastEngine
 std::vector<FinancialForecast> Analytics::GenerateForecast(const std::wstring& userId, int monthsAhead) {
-    std::vector<FinancialForecast> forecasts;
-    auto historicalData = GetMonthlyData(userId, 12); // Use 12 months of history
-
-    if (historicalData.size() < 3) {
-        // Not enough data for meaningful forecast
-        return forecasts;
-    }
-
-    // Prepare historical data for trend analysis
-    std::vector<double> incomeHistory, expenseHistory;
-    for (auto it = historicalData.rbegin(); it != historicalData.rend(); ++it) {
-        incomeHistory.push_back(it->totalIncome);
-        expenseHistory.push_back(it->totalExpenses);
-    }
-
-    // Calculate trends using simple linear regression
-    auto incomeCoeffs = AdvancedAnalyticsHelpers::LinearRegression(
-        std::vector<double>(incomeHistory.size()), incomeHistory);
-    auto expenseCoeffs = AdvancedAnalyticsHelpers::LinearRegression(
-        std::vector<double>(expenseHistory.size()), expenseHistory);
-
-    // Generate forecasts
-    for (int i = 1; i <= monthsAhead; ++i) {
-        FinancialForecast forecast;
-
-        // Generate period string (simplified)
-        auto now = std::chrono::system_clock::now();
-        auto time_t = std::chrono::system_clock::to_time_t(now);
-        auto tm = *std::localtime(&time_t);
-        tm.tm_mon += i;
-        if (tm.tm_mon > 11) {
-            tm.tm_year++;
-            tm.tm_mon -= 12;
-        }
-
-        wchar_t periodStr[32];
-        swprintf_s(periodStr, L"%04d-%02d", tm.tm_year + 1900, tm.tm_mon + 1);
-        forecast.period = periodStr;
-
-        double x = static_cast<double>(incomeHistory.size() + i);
-        forecast.predictedIncome = AdvancedAnalyticsHelpers::PredictValue(incomeCoeffs, x);
-        forecast.predictedExpenses = AdvancedAnalyticsHelpers::PredictValue(expenseCoeffs, x);
-        forecast.predictedBalance = forecast.predictedIncome - forecast.predictedExpenses;
-
-        // Calculate confidence based on data consistency
-        double incomeVolatility = CalculateStandardDeviation(incomeHistory);
-        double expenseVolatility = CalculateStandardDeviation(expenseHistory);
-        double avgIncome = CalculateAverage(incomeHistory);
-        double avgExpenses = CalculateAverage(expenseHistory);
-
-        double incomeCV = avgIncome > 0 ? incomeVolatility / avgIncome : 1.0;
-        double expenseCV = avgExpenses > 0 ? expenseVolatility / avgExpenses : 1.0;
-
-        // Lower coefficient of variation means higher confidence
-        forecast.confidence = std::max(0.1, 1.0 - (incomeCV + expenseCV) / 2.0);
-        forecast.confidence = std::min(0.95, forecast.confidence); // Cap at 95%
-
-        forecasts.push_back(forecast);
-    }
-
-    return forecasts;
+    return ForecastEngine::Forecast(userId, monthsAhead);
 }
 
 double Analytics::PredictNextMonthExpenses(const std::wstring& userId) {
-    auto forecasts = GenerateForecast(userId, 1);
+    auto forecasts = ForecastEngine::Forecast(userId, 1);
     return forecasts.empty() ? 0.0 : forecasts[0].predictedExpenses;
 }
 
 double Analytics::PredictNextMonthIncome(const std::wstring& userId) {
-    auto forecasts = GenerateForecast(userId, 1);
+    auto forecasts = ForecastEngine::Forecast(userId, 1);
     return forecasts.empty() ? 0.0 : forecasts[0].predictedIncome;
 }
 
@@ -485,9 +475,13 @@ std::vector<std::wstring> Analytics::DetectSpendingPatterns(const std::wstring&
 }
 
 std::vector<std::wstring> Analytics::GetFinancialInsights(const std::wstring& userId) {
+    auto userBudgets = UserDataFilter::GetUserBudgets(userId);
+    return GetFinancialInsights(GetMonthlyData(userId, 6), std::vector<Budget>(userBudgets.begin(), userBudgets.end()));
+}
+
+std::vector<std::wstring> Analytics::GetFinancialInsights(const std::vector<MonthlyFinancialData>& monthlyData, const std::vector<Budget>& userBudgets) {
     std::vector<std::wstring> insights;
 
-    auto monthlyData = GetMonthlyData(userId, 6);
     if (monthlyData.size() < 2) return insights;
 
     // Income vs Expenses trend
@@ -518,7 +512,6 @@ std::vector<std::wstring> Analytics::GetFinancialInsights(const std::wstring& us
     }
 
     // Budget performance
-    auto userBudgets = UserDataFilter::GetUserBudgets(userId);
     int overBudgetCount = 0;
     for (const auto& budget : userBudgets) {
         if (budget.isActive && budget.currentSpent > budget.monthlyLimit) {
@@ -585,40 +578,17 @@ std::vector<std::wstring> Analytics::GetRecommendations(const std::wstring& user
 
 }
 
-// Statistical functions
+// Statistical functions; see StatsKernels
 double Analytics::CalculateStandardDeviation(const std::vector<double>& values) {
-    if (values.size() < 2) return 0.0;
-
-    double mean = CalculateAverage(values);
-    double sumSquaredDiffs = 0.0;
-
-    for (double value : values) {
-        double diff = value - mean;
-        sumSquaredDiffs += diff * diff;
-    }
-
-    return std::sqrt(sumSquaredDiffs / (values.size() - 1));
+    return StatsKernels::StandardDeviation(values);
 }
 
 double Analytics::CalculateMedian(std::vector<double> values) {
-    if (values.empty()) return 0.0;
-
-    std::sort(values.begin(), values.end());
-    size_t size = values.size();
-
-    if (size % 2 == 0) {
-        return (values[size / 2 - 1] + values[size / 2]) / 2.0;
-    }
-    else {
-        return values[size / 2];
-    }
+    return StatsKernels::Median(values);   // Selects within the copy taken by value
 }
 
 double Analytics::CalculateAverage(const std::vector<double>& values) {
-    if (values.empty()) return 0.0;
-
-    double sum = std::accumulate(values.begin(), values.end(), 0.0);
-    return sum / values.size();
+    return StatsKernels::Mean(values);
 }
 
 std::pair<double, double> Analytics::GetMinMax(const std::vector<double>& values) {
@@ -628,6 +598,25 @@ std::pair<double, double> Analytics::GetMinMax(const std::vector<double>& values
     return { *minMax.first, *minMax.second };
 }
 
+double Analytics::GetExpensePercentile(const std::wstring& userId, double percentile, const std::wstring& category, const DateRange& range) {
+    SymbolId userSymbol = SymbolTable::Find(userId);
+    if (userSymbol == INVALID_SYMBOL) return 0.0;
+
+    SymbolId categorySymbol = INVALID_SYMBOL;
+    if (!category.empty()) {
+        categorySymbol = SymbolTable::Find(category);
+        if (categorySymbol == INVALID_SYMBOL) return 0.0;
+    }
+
+    // Merges the sketches of the months in the range; no expense is sorted
+    QuantileSketch sketch = quantileIndex.Expenses(userSymbol, categorySymbol, ToDayRange(range), GetReportingCurrency(userId));
+    return sketch.Quantile(percentile / 100.0);
+}
+
+double Analytics::GetMedianExpense(const std::wstring& userId, const std::wstring& category, const DateRange& range) {
+    return GetExpensePercentile(userId, 50.0, category, range);
+}
+
 // Utility functions
 std::wstring Analytics::FormatCurrency(double amount) {
     std::wstringstream ss;
@@ -749,3 +738,115 @@ void Analytics::PopulateSummaryData(HWND hDlg, const std::wstring& userId) {
 
 }
     
+
+// Advanced analytics
+// Statistical helpers
+std::vector<double> AdvancedAnalytics::CalculateMovingAverage(const std::vector<double>& values, int window) {
+    if (window <= 0 || values.size() < static_cast<size_t>(window)) return {};
+
+    std::vector<double> averages(values.size() - window + 1);
+    StatsKernels::MovingAverage(values, window, averages);
+    return averages;
+}
+
+double AdvancedAnalytics::CalculateCorrelation(const std::vector<double>& x, const std::vector<double>& y) {
+    return StatsKernels::Correlation(x, y);
+}
+
+// Coefficients by power of x: { intercept, slope }
+std::vector<double> AdvancedAnalytics::LinearRegression(const std::vector<double>& x, const std::vector<double>& y) {
+    LineFit fit = StatsKernels::FitLine(x, y);
+    return { fit.intercept, fit.slope };
+}
+
+double AdvancedAnalytics::PredictValue(const std::vector<double>& coefficients, double x) {
+    double value = 0.0;
+    for (auto it = coefficients.rbegin(); it != coefficients.rend(); ++it) {
+        value = value * x + *it;
+    }
+    return value;
+}
+
+// Values more than threshold standard deviations from their mean
+std::vector<double> AdvancedAnalytics::DetectOutliers(const std::vector<double>& values, double threshold) {
+    std::vector<double> outliers;
+
+    double mean = StatsKernels::Mean(values);
+    double deviation = StatsKernels::StandardDeviation(values);
+    if (deviation <= 0.0) return outliers;
+
+    for (double value : values) {
+        if (std::abs(value - mean) > threshold * deviation) outliers.push_back(value);
+    }
+    return outliers;
+}
+
+// Standard deviation of the category's expenses in the user's currency, read
+// from the streaming statistics kept as expenses are added. Those are kept
+// per currency; each currency's count, mean and squared deviations are
+// scaled at current rates and pooled.
+double AdvancedAnalytics::GetExpenseVolatility(const std::wstring& userId, const std::wstring& category) {
+    SymbolId userSymbol = SymbolTable::Find(userId);
+    SymbolId categorySymbol = SymbolTable::Find(category);
+    if (userSymbol == INVALID_SYMBOL || categorySymbol == INVALID_SYMBOL) return 0.0;
+
+    double factors[CURRENCY_TYPE_COUNT];
+    CurrencyManager::FactorsOn(GetReportingCurrency(userId), INVALID_DAY, factors);
+
+    double count = 0.0, weightedSum = 0.0;
+    for (int currency = 0; currency < CURRENCY_TYPE_COUNT; ++currency) {
+        const SpendingStats& stats = anomalyIndex.Stats(userSymbol, categorySymbol, static_cast<CurrencyType>(currency));
+        count += stats.count;
+        weightedSum += stats.count * stats.mean * factors[currency];
+    }
+    if (count < 2) return 0.0;
+
+    double mean = weightedSum / count;
+    double m2 = 0.0;
+    for (int currency = 0; currency < CURRENCY_TYPE_COUNT; ++currency) {
+        const SpendingStats& stats = anomalyIndex.Stats(userSymbol, categorySymbol, static_cast<CurrencyType>(currency));
+        double offset = stats.mean * factors[currency] - mean;
+        m2 += stats.m2 * factors[currency] * factors[currency] + stats.count * offset * offset;
+    }
+    return std::sqrt(m2 / (count - 1));   // Sample, as SpendingStats::Variance
+}
+
+// Expenses that were more than threshold standard deviations above their
+// category's recent mean when they were added, most unusual first. Scores are
+// taken at insert time (see AnomalyIndex), so at the default threshold this
+// only reads the user's flagged rows; a lower threshold scans the user's
+// score column.
+std::vector<std::wstring> AdvancedAnalytics::GetExpenseAnomalies(const std::wstring& userId, double threshold) {
+    std::vector<std::pair<double, std::wstring>> found;
+
+    SymbolId userSymbol = SymbolTable::Find(userId);
+    if (userSymbol == INVALID_SYMBOL) return {};
+
+    auto addIfAnomalous = [&](uint32_t row) {
+        AnomalyScore score = anomalyIndex.Score(row);
+        if (!(score.score >= threshold)) return;   // Also skips unscored rows
+
+        const Expense& expense = ledger.Row(row).GetExpense();
+        std::wstringstream ss;
+        ss << expense.category << L": " << Analytics::FormatCurrency(expense.amount) << L" on " << expense.date.substr(0, 10)
+            << L" (" << std::fixed << std::setprecision(1) << score.score << L" std dev above the "
+            << Analytics::FormatCurrency(score.baseline) << L" recent average)";
+        found.emplace_back(score.score, ss.str());
+    };
+
+    if (threshold >= ANOMALY_Z_THRESHOLD) {
+        for (uint32_t row : anomalyIndex.FlaggedRows(userSymbol)) addIfAnomalous(row);
+    }
+    else {
+        auto flagColumn = ledger.Flags();
+        for (const auto& entry : userTimeline.Range(userSymbol, DayRange())) {
+            if (!(flagColumn[entry.row] & LEDGER_INCOME)) addIfAnomalous(entry.row);
+        }
+    }
+
+    std::sort(found.begin(), found.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    std::vector<std::wstring> anomalies;
+    for (auto& item : found) anomalies.push_back(std::move(item.second));
+    return anomalies;
+}
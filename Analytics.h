@@ -41,6 +41,14 @@ struct FinancialForecast {
     double confidence; // 0-1
 };
 
+// All-time figures shown on the dashboard cards, in the user's default currency
+struct DashboardMetrics {
+    double totalIncome;
+    double totalExpenses;
+    double balance;
+    double savingsRate;   // Percent of income not spent
+};
+
 struct ComparisonData {
     std::wstring period1;
     std::wstring period2;
@@ -66,10 +74,14 @@ public:
     static double GetAverageMonthlyIncome(const std::wstring& userId, int months = 12);
     static double GetAverageMonthlyExpenses(const std::wstring& userId, int months = 12);
 
+    // Cached per user; recomputed only after the ledger or the user's currency changes
+    static DashboardMetrics GetDashboardMetrics(const std::wstring& userId);
+
     
     // Trend analysis
     static std::vector<SpendingTrend> GetSpendingTrends(const std::wstring& userId, const std::wstring& period = L"monthly");
     static std::vector<MonthlyFinancialData> GetMonthlyData(const std::wstring& userId, int months = 12);
+    static std::vector<MonthlyFinancialData> GetMonthlyData(SymbolId user, CurrencyType target, int months);
     static double GetGrowthRate(const std::vector<double>& values);
     static std::wstring GetTrendDirection(const std::vector<double>& values);
 
@@ -77,6 +89,7 @@ public:
     static std::vector<CategoryAnalytics> GetCategoryAnalytics(const std::wstring& userId, const DateRange& range = DateRange());
     static std::map<std::wstring, double> GetCategoryTotals(const std::wstring& userId, const DateRange& range = DateRange());
     static std::vector<std::wstring> GetTopCategories(const std::wstring& userId, int count = 5, const DateRange& range = DateRange());
+    static std::vector<Expense> GetLargestExpenses(const std::wstring& userId, int count = 10, const DateRange& range = DateRange());
     static double GetCategoryGrowthRate(const std::wstring& userId, const std::wstring& category, int months = 6);
 
     // Comparison analysis
@@ -92,6 +105,8 @@ public:
     // Pattern analysis
     static std::vector<std::wstring> DetectSpendingPatterns(const std::wstring& userId);
     static std::vector<std::wstring> GetFinancialInsights(const std::wstring& userId);
+    // From the user's last six months of GetMonthlyData and their budgets
+    static std::vector<std::wstring> GetFinancialInsights(const std::vector<MonthlyFinancialData>& monthlyData, const std::vector<Budget>& userBudgets);
     static std::vector<std::wstring> GetRecommendations(const std::wstring& userId);
 
     // Time-based analysis
@@ -105,6 +120,12 @@ public:
     static double CalculateAverage(const std::vector<double>& values);
     static std::pair<double, double> GetMinMax(const std::vector<double>& values);
 
+    // Approximate, from the quantile sketches: the given percentile (0-100) or
+    // the median of the user's expenses in the range, in one category or all
+    // of them (empty), in the user's currency
+    static double GetExpensePercentile(const std::wstring& userId, double percentile, const std::wstring& category = L"", const DateRange& range = DateRange());
+    static double GetMedianExpense(const std::wstring& userId, const std::wstring& category = L"", const DateRange& range = DateRange());
+
     // Export functions
     static bool ExportAnalyticsToCSV(const std::wstring& filePath, const std::wstring& userId, const std::wstring& analysisType);
     static bool ExportAnalyticsToPDF(const std::wstring& filePath, const std::wstring& userId, const std::wstring& analysisType);
@@ -0,0 +1,138 @@
+#include "AnomalyIndex.h"
+#include "LedgerTimeline.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+AnomalyIndex anomalyIndex;
+
+static const AnomalyScore UNSCORED = { std::numeric_limits<double>::quiet_NaN(), 0.0 };
+
+// SpendingStats
+void SpendingStats::Add(double amount) {
+    ++count;
+    double delta = amount - mean;
+    mean += delta / count;
+    m2 += delta * (amount - mean);
+
+    if (count == 1) {
+        recentMean = amount;
+        recentVariance = 0.0;
+    }
+    else {
+        double recentDelta = amount - recentMean;
+        double step = ANOMALY_EWMA_ALPHA * recentDelta;
+        recentMean += step;
+        recentVariance = (1.0 - ANOMALY_EWMA_ALPHA) * (recentVariance + recentDelta * step);
+    }
+}
+
+void SpendingStats::Remove(double amount) {
+    if (count <= 1) {
+        *this = SpendingStats();
+        return;
+    }
+
+    double previousMean = mean;
+    --count;
+    mean = (previousMean * (count + 1) - amount) / count;
+    // Rounding can leave a tiny negative sum
+    m2 = std::max(0.0, m2 - (amount - mean) * (amount - previousMean));
+}
+
+double SpendingStats::StandardDeviation() const {
+    return std::sqrt(Variance());
+}
+
+double SpendingStats::RecentDeviation() const {
+    return std::sqrt(recentVariance);
+}
+
+// AnomalyIndex
+const SpendingStats& AnomalyIndex::Stats(SymbolId user, SymbolId category, CurrencyType currency) const {
+    static const SpendingStats none;
+    auto it = stats.find(Key(user, category));
+    return it != stats.end() ? it->second[static_cast<size_t>(currency)] : none;
+}
+
+AnomalyScore AnomalyIndex::Score(size_t row) const {
+    return row < scores.size() ? scores[row] : UNSCORED;
+}
+
+std::span<const uint32_t> AnomalyIndex::FlaggedRows(SymbolId user) const {
+    auto it = flagged.find(user);
+    return it != flagged.end() ? std::span<const uint32_t>(it->second) : std::span<const uint32_t>();
+}
+
+void AnomalyIndex::OnRebuilt() {
+    OnCleared();
+    scores.assign(ledger.Size(), UNSCORED);
+
+    // The timeline is attached first, so it is already rebuilt
+    for (const auto& entry : ledgerTimeline) OnRowAdded(entry.row);
+}
+
+void AnomalyIndex::OnCleared() {
+    stats.clear();
+    scores.clear();
+    flagged.clear();
+}
+
+void AnomalyIndex::OnRowAdded(size_t row) {
+    if (row >= scores.size()) scores.resize(ledger.Size(), UNSCORED);
+    scores[row] = UNSCORED;
+    if (ledger.Flags()[row] & LEDGER_INCOME) return;
+
+    SymbolId user = ledger.Users()[row];
+    double amount = ledger.Amounts()[row];
+    SpendingStats& history = stats[Key(user, ledger.Categories()[row])][ledger.Currencies()[row]];
+
+    // Scored before it joins the history it is compared to
+    double deviation = history.RecentDeviation();
+    if (history.count >= ANOMALY_MIN_HISTORY && deviation > 0.0) {
+        scores[row] = { (amount - history.recentMean) / deviation, history.recentMean };
+        if (scores[row].score >= ANOMALY_Z_THRESHOLD) flagged[user].push_back(static_cast<uint32_t>(row));
+    }
+    history.Add(amount);
+}
+
+void AnomalyIndex::OnRowRemoving(size_t row) {
+    if (ledger.Flags()[row] & LEDGER_INCOME) return;
+
+    auto it = stats.find(Key(ledger.Users()[row], ledger.Categories()[row]));
+    if (it != stats.end()) {
+        it->second[ledger.Currencies()[row]].Remove(ledger.Amounts()[row]);
+        bool empty = std::all_of(it->second.begin(), it->second.end(), [](const SpendingStats& s) { return s.count == 0; });
+        if (empty) stats.erase(it);
+    }
+    Unflag(row);
+}
+
+void AnomalyIndex::OnRowsRemoved(std::span<const uint32_t> rows) {
+    for (uint32_t row : rows) OnRowRemoving(row);
+}
+
+void AnomalyIndex::OnRowMoved(size_t from, size_t to) {
+    // 'to' is dead, so already unflagged
+    scores[to] = scores[from];
+    scores[from] = UNSCORED;
+
+    if (scores[to].score >= ANOMALY_Z_THRESHOLD) {
+        auto& rows = flagged[ledger.Users()[from]];
+        std::replace(rows.begin(), rows.end(), static_cast<uint32_t>(from), static_cast<uint32_t>(to));
+    }
+}
+
+void AnomalyIndex::Unflag(size_t row) {
+    if (row >= scores.size()) return;
+
+    if (scores[row].score >= ANOMALY_Z_THRESHOLD) {
+        auto it = flagged.find(ledger.Users()[row]);
+        if (it != flagged.end()) {
+            auto& rows = it->second;
+            rows.erase(std::remove(rows.begin(), rows.end(), static_cast<uint32_t>(row)), rows.end());
+            if (rows.empty()) flagged.erase(it);
+        }
+    }
+    scores[row] = UNSCORED;
+}
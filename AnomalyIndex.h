@@ -0,0 +1,79 @@
+#pragma once
+#include "Ledger.h"
+#include <array>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+// Standard deviations above the recent mean at which an expense is flagged
+const double ANOMALY_Z_THRESHOLD = 2.0;
+// Expenses a category needs before new ones are scored
+const uint32_t ANOMALY_MIN_HISTORY = 5;
+// Weight of the newest expense in the recent mean and variance
+const double ANOMALY_EWMA_ALPHA = 0.1;
+
+// Streaming statistics of one user's spending in one category and currency.
+// The Welford mean and variance cover every expense and are exactly reversed
+// on removal. The exponentially weighted ones follow recent spending; they
+// cannot be reversed, so a removed or edited expense stays in them until
+// the next rebuild.
+struct SpendingStats {
+    uint32_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;            // Sum of squared deviations from the mean
+    double recentMean = 0.0;
+    double recentVariance = 0.0;
+
+    void Add(double amount);
+    void Remove(double amount);
+
+    double Variance() const { return count > 1 ? m2 / (count - 1) : 0.0; }   // Sample
+    double StandardDeviation() const;
+    double RecentDeviation() const;
+};
+
+// An expense's score, taken when it was added: how far it sat above the
+// category's recent mean in its currency, in recent standard deviations
+struct AnomalyScore {
+    double score;       // NaN if the category had too little history
+    double baseline;    // Recent mean it was compared to
+};
+
+// Scores each expense against its user and category's history in the same
+// currency as it is added, so anomaly queries read stored scores instead of recomputing
+// statistics. A rebuild replays the rows in date order, giving every
+// expense the score it would have had when it was entered; an edited
+// expense is rescored against the history at the time of the edit.
+class AnomalyIndex : public LedgerIndex {
+public:
+    // Empty stats for a user, category and currency without expenses
+    const SpendingStats& Stats(SymbolId user, SymbolId category, CurrencyType currency) const;
+
+    AnomalyScore Score(size_t row) const;
+    bool IsAnomaly(size_t row) const { return Score(row).score >= ANOMALY_Z_THRESHOLD; }
+
+    // The user's flagged expense rows, in no particular order. Valid until the next ledger change.
+    std::span<const uint32_t> FlaggedRows(SymbolId user) const;
+
+    void OnRebuilt() override;
+    void OnCleared() override;
+    void OnRowAdded(size_t row) override;
+    void OnRowRemoving(size_t row) override;
+    void OnRowsRemoved(std::span<const uint32_t> rows) override;
+    void OnRowMoved(size_t from, size_t to) override;
+
+private:
+    static uint64_t Key(SymbolId user, SymbolId category) { return (uint64_t(user) << 32) | category; }
+
+    void Unflag(size_t row);
+
+    // Amounts are only compared within one currency, so each user and
+    // category keeps separate stats per currency
+    using CurrencyStats = std::array<SpendingStats, CURRENCY_TYPE_COUNT>;
+
+    std::unordered_map<uint64_t, CurrencyStats> stats;
+    std::vector<AnomalyScore> scores;                              // By row; incomes are never scored
+    std::unordered_map<SymbolId, std::vector<uint32_t>> flagged;   // By user
+};
+
+extern AnomalyIndex anomalyIndex;
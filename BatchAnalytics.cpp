@@ -0,0 +1,139 @@
+#include "BatchAnalytics.h"
+#include "CurrencyManager.h"
+#include "ForecastEngine.h"
+#include "Ledger.h"
+#include "QueryPlanner.h"
+#include "Utils.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <unordered_map>
+
+// A user's rows of one kind as contiguous columns for the conversion kernel
+struct PartitionColumns {
+    std::vector<double> amounts;
+    std::vector<uint8_t> currencies;
+    std::vector<int32_t> days;
+};
+
+struct UserPartition {
+    SymbolId symbol = INVALID_SYMBOL;
+    PartitionColumns kinds[2];   // Expenses, incomes
+    std::unordered_map<SymbolId, CategoryTally> categories;   // Expenses by category id
+    std::vector<Budget> budgets;
+
+    size_t RowCount() const { return kinds[0].amounts.size() + kinds[1].amounts.size(); }
+};
+
+static double SumPartition(const PartitionColumns& columns, CurrencyType target) {
+    return CurrencyManager::SumConvertedOn(columns.amounts, columns.currencies, columns.days, target);
+}
+
+BatchAnalyticsResult BatchAnalytics::Run(const DateRange& range, int forecastMonths, unsigned threadCount) {
+    BatchAnalyticsResult result;
+    auto start = std::chrono::steady_clock::now();
+
+    // One pass over the ledger splits the rows in range by user, and one
+    // over the budgets splits those
+    std::vector<UserPartition> partitions(users.size());
+    std::unordered_map<SymbolId, size_t> partitionOf;
+    for (size_t i = 0; i < users.size(); ++i) {
+        SymbolId symbol = SymbolTable::Find(users[i].username);
+        partitions[i].symbol = symbol;
+        if (symbol != INVALID_SYMBOL) partitionOf.emplace(symbol, i);
+    }
+
+    DayRange days = ToDayRange(range);
+    auto dayColumn = ledger.Days();
+    auto amountColumn = ledger.Amounts();
+    auto currencyColumn = ledger.Currencies();
+    auto userColumn = ledger.Users();
+    auto categoryColumn = ledger.Categories();
+    auto flagColumn = ledger.Flags();
+    ledger.ForEachRow([&](size_t row) {
+        if (!days.Contains(dayColumn[row])) return;
+        auto it = partitionOf.find(userColumn[row]);
+        if (it == partitionOf.end()) return;
+
+        UserPartition& partition = partitions[it->second];
+        bool income = flagColumn[row] & LEDGER_INCOME;
+        PartitionColumns& columns = partition.kinds[income ? 1 : 0];
+        columns.amounts.push_back(amountColumn[row]);
+        columns.currencies.push_back(currencyColumn[row]);
+        columns.days.push_back(dayColumn[row]);
+        if (!income) {
+            CategoryTally& tally = partition.categories[categoryColumn[row]];
+            tally.total += amountColumn[row];
+            ++tally.count;
+        }
+    });
+
+    for (const auto& budget : budgets) {
+        auto it = partitionOf.find(SymbolTable::Find(budget.userId));
+        if (it != partitionOf.end()) partitions[it->second].budgets.push_back(budget);
+    }
+
+    // Users with the most rows first, so the long tasks start early and
+    // stealing evens out the tail
+    std::vector<size_t> order(users.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&partitions](size_t a, size_t b) {
+        return partitions[a].RowCount() > partitions[b].RowCount();
+    });
+
+    result.reports.resize(users.size());
+    std::vector<std::function<void()>> tasks;
+    tasks.reserve(order.size());
+    for (size_t i : order) {
+        tasks.push_back([&, i] {
+            const User& user = users[i];
+            UserPartition& partition = partitions[i];
+            UserAnalyticsReport& report = result.reports[i];
+            report.userId = user.username;
+
+            DashboardMetrics& summary = report.summary;
+            summary.totalIncome = SumPartition(partition.kinds[1], user.defaultCurrency);
+            summary.totalExpenses = SumPartition(partition.kinds[0], user.defaultCurrency);
+            summary.balance = summary.totalIncome - summary.totalExpenses;
+            summary.savingsRate = summary.totalIncome > 0 ? summary.balance / summary.totalIncome * 100 : 0.0;
+
+            std::map<std::wstring, CategoryTally> tallies;
+            for (const auto& pair : partition.categories) {
+                tallies[std::wstring(SymbolTable::Resolve(pair.first))] = pair.second;
+            }
+            report.categories = BuildCategoryAnalytics(tallies, partition.budgets);
+
+            // Forecasts and insights read the user's months in the rollup cube
+            report.forecast = ForecastEngine::Forecast(user, forecastMonths);
+            if (partition.symbol != INVALID_SYMBOL) {
+                report.insights = Analytics::GetFinancialInsights(
+                    Analytics::GetMonthlyData(partition.symbol, user.defaultCurrency, 6), partition.budgets);
+            }
+            partition = UserPartition();   // Free as soon as it is used
+        });
+    }
+
+    // Plans must not be logged from several workers at once
+    bool tracing = traceQueryPlans;
+    traceQueryPlans = false;
+
+    WorkStealingPool pool(threadCount);
+    result.threads = pool.ThreadCount();
+    try {
+        pool.Run(tasks);
+    }
+    catch (const std::exception& e) {
+        LogError(StringToWString(e.what()), L"BatchAnalytics::Run");
+    }
+    traceQueryPlans = tracing;
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.usersPerSecond = result.seconds > 0.0 ? users.size() / result.seconds : 0.0;
+
+    LogInfo(L"Batch analytics: " + std::to_wstring(users.size()) + L" users in "
+        + std::to_wstring(static_cast<int>(result.seconds * 1000)) + L" ms on "
+        + std::to_wstring(result.threads) + L" threads ("
+        + std::to_wstring(static_cast<int>(result.usersPerSecond)) + L" users/sec)");
+    return result;
+}
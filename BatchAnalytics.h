@@ -0,0 +1,31 @@
+#pragma once
+#include "Analytics.h"
+#include <string>
+#include <vector>
+
+// One user's figures from a batch run
+struct UserAnalyticsReport {
+    std::wstring userId;
+    DashboardMetrics summary;                    // Over the batch's range, in the user's currency
+    std::vector<CategoryAnalytics> categories;
+    std::vector<FinancialForecast> forecast;
+    std::vector<std::wstring> insights;
+};
+
+struct BatchAnalyticsResult {
+    std::vector<UserAnalyticsReport> reports;    // In the order of the users list
+    unsigned threads = 0;
+    double seconds = 0.0;
+    double usersPerSecond = 0.0;
+};
+
+// Summaries, category analytics, forecasts and insights for every user,
+// computed in parallel on a work-stealing pool. The ledger and the budgets
+// are split by user in one pass each; workers read their user's partition
+// and rollup months, never the global stores. Blocks the calling thread,
+// which must be the one that changes the data, so nothing changes while
+// workers read it. Query plan tracing is off while they run.
+class BatchAnalytics {
+public:
+    static BatchAnalyticsResult Run(const DateRange& range = DateRange(), int forecastMonths = 3, unsigned threads = 0);
+};
@@ -0,0 +1,16 @@
+#pragma once
+#include <string>
+
+// Microbenchmarks of the analytics kernels and ledger indexes against the
+// scalar code they replaced, on synthetic data. Started with /benchmark on the
+// command line: the report goes to benchmarks.txt and the app exits without
+// opening a window or touching the data file.
+class Benchmarks {
+public:
+    // Runs every suite and writes the report to path; false if it cannot be written
+    static bool WriteReport(const std::wstring& path);
+
+    // Each returns its report section
+    static std::wstring RunStatsKernels();
+    static std::wstring RunDateRanges();   // Fills the record stores with its own data
+};
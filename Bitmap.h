@@ -0,0 +1,54 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Helpers for flat bitmaps stored as arrays of 64-bit words
+
+inline size_t BitmapWords(size_t bits) {
+    return (bits + 63) / 64;
+}
+
+inline bool TestBit(std::span<const uint64_t> words, size_t bit) {
+    return (words[bit >> 6] >> (bit & 63)) & 1;
+}
+
+inline void SetBit(std::span<uint64_t> words, size_t bit) {
+    words[bit >> 6] |= uint64_t(1) << (bit & 63);
+}
+
+inline void ClearBit(std::span<uint64_t> words, size_t bit) {
+    words[bit >> 6] &= ~(uint64_t(1) << (bit & 63));
+}
+
+// First set bit in [from, limit), or limit when there is none.
+// Skips a whole word per step, so long runs of clear bits cost 1/64 per bit.
+inline size_t NextSetBit(std::span<const uint64_t> words, size_t from, size_t limit) {
+    if (from >= limit) return limit;
+
+    size_t word = from >> 6;
+    uint64_t bits = words[word] & (~uint64_t(0) << (from & 63));
+    while (bits == 0) {
+        if (++word >= BitmapWords(limit)) return limit;
+        bits = words[word];
+    }
+
+    size_t bit = (word << 6) + std::countr_zero(bits);
+    return bit < limit ? bit : limit;
+}
+
+// First clear bit in [from, limit), or limit when there is none
+inline size_t NextClearBit(std::span<const uint64_t> words, size_t from, size_t limit) {
+    if (from >= limit) return limit;
+
+    size_t word = from >> 6;
+    uint64_t bits = ~words[word] & (~uint64_t(0) << (from & 63));
+    while (bits == 0) {
+        if (++word >= BitmapWords(limit)) return limit;
+        bits = ~words[word];
+    }
+
+    size_t bit = (word << 6) + std::countr_zero(bits);
+    return bit < limit ? bit : limit;
+}
@@ -0,0 +1,86 @@
+#include "CategoryTagIndex.h"
+
+CategoryTagIndex categoryTagIndex;
+
+static RowBitmap UnionOf(const std::unordered_map<SymbolId, RowBitmap>& bitmaps, std::span<const SymbolId> keys) {
+    RowBitmap result;
+    for (SymbolId key : keys) {
+        auto it = bitmaps.find(key);
+        if (it != bitmaps.end()) result |= it->second;
+    }
+    return result;
+}
+
+static size_t CountOf(const std::unordered_map<SymbolId, RowBitmap>& bitmaps, std::span<const SymbolId> keys) {
+    size_t total = 0;
+    for (SymbolId key : keys) {
+        auto it = bitmaps.find(key);
+        if (it != bitmaps.end()) total += it->second.Cardinality();
+    }
+    return total;
+}
+
+RowBitmap CategoryTagIndex::AnyCategory(std::span<const SymbolId> categories) const {
+    return UnionOf(byCategory, categories);
+}
+
+RowBitmap CategoryTagIndex::AnyTag(std::span<const SymbolId> tags) const {
+    return UnionOf(byTag, tags);
+}
+
+size_t CategoryTagIndex::CategoryRowCount(std::span<const SymbolId> categories) const {
+    return CountOf(byCategory, categories);
+}
+
+size_t CategoryTagIndex::TagRowCount(std::span<const SymbolId> tags) const {
+    return CountOf(byTag, tags);
+}
+
+void CategoryTagIndex::OnRebuilt() {
+    OnCleared();
+    ledger.ForEachRow([this](size_t row) { Add(row, static_cast<uint32_t>(row)); });
+}
+
+void CategoryTagIndex::OnCleared() {
+    byCategory.clear();
+    byTag.clear();
+}
+
+void CategoryTagIndex::OnRowAdded(size_t row) {
+    Add(row, static_cast<uint32_t>(row));
+}
+
+void CategoryTagIndex::OnRowRemoving(size_t row) {
+    Remove(row, static_cast<uint32_t>(row));
+}
+
+void CategoryTagIndex::OnRowsRemoved(std::span<const uint32_t> rows) {
+    for (uint32_t row : rows) Remove(row, row);
+}
+
+void CategoryTagIndex::OnRowMoved(size_t from, size_t to) {
+    Remove(from, static_cast<uint32_t>(from));
+    Add(from, static_cast<uint32_t>(to));
+}
+
+// Adds the category and tags read from 'row' under the id 'as'
+void CategoryTagIndex::Add(size_t row, uint32_t as) {
+    byCategory[ledger.Categories()[row]].Add(as);
+    for (SymbolId tag : ledger.Tags(row)) byTag[tag].Add(as);
+}
+
+void CategoryTagIndex::Remove(size_t row, uint32_t as) {
+    auto it = byCategory.find(ledger.Categories()[row]);
+    if (it != byCategory.end()) {
+        it->second.Remove(as);
+        if (it->second.Empty()) byCategory.erase(it);
+    }
+
+    for (SymbolId tag : ledger.Tags(row)) {
+        auto tagIt = byTag.find(tag);
+        if (tagIt == byTag.end()) continue;
+
+        tagIt->second.Remove(as);
+        if (tagIt->second.Empty()) byTag.erase(tagIt);
+    }
+}
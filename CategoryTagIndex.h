@@ -0,0 +1,36 @@
+#pragma once
+#include "Ledger.h"
+#include "RowBitmap.h"
+#include <span>
+#include <unordered_map>
+
+// Row bitmaps per category (source for incomes) and per tag. Filters on
+// several categories and tags resolve to a row set with OR/AND before any
+// record is read, and the result composes with other row sets.
+class CategoryTagIndex : public LedgerIndex {
+public:
+    // Rows in any of the categories / carrying any of the tags
+    RowBitmap AnyCategory(std::span<const SymbolId> categories) const;
+    RowBitmap AnyTag(std::span<const SymbolId> tags) const;
+
+    // Sizes of the above without building them. Exact for categories; for
+    // tags an upper bound, as a row with two of the tags counts twice.
+    size_t CategoryRowCount(std::span<const SymbolId> categories) const;
+    size_t TagRowCount(std::span<const SymbolId> tags) const;
+
+    void OnRebuilt() override;
+    void OnCleared() override;
+    void OnRowAdded(size_t row) override;
+    void OnRowRemoving(size_t row) override;
+    void OnRowsRemoved(std::span<const uint32_t> rows) override;
+    void OnRowMoved(size_t from, size_t to) override;
+
+private:
+    void Add(size_t row, uint32_t as);
+    void Remove(size_t row, uint32_t as);
+
+    std::unordered_map<SymbolId, RowBitmap> byCategory;
+    std::unordered_map<SymbolId, RowBitmap> byTag;
+};
+
+extern CategoryTagIndex categoryTagIndex;
@@ -1,5 +1,313 @@
 #include "CurrencyManager.h"
+#include "Utils.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CURRENCY_SSE2 1
+#endif
+
+// rates[to][from]: a target's factors are one contiguous row
+alignas(64) static double rates[CURRENCY_TYPE_COUNT][CURRENCY_TYPE_COUNT];
+
+static const bool ratesInitialized = [] {
+    CurrencyManager::SetUsdRates(DEFAULT_USD_RATES);
+    return true;
+}();
+
+// Rate history, day-major: row d holds the rates on firstHistoryDay + d.
+// Both directions are stored so a factor is two loads and a multiply.
+struct DayRates {
+    double unitsPerUsd[CURRENCY_TYPE_COUNT];
+    double usdPerUnit[CURRENCY_TYPE_COUNT];
+};
+
+static std::vector<DayRates> rateHistory;
+static int firstHistoryDay = 0;
+static uint64_t ratesVersion = 0;
+
+// Longest history accepted, about two centuries
+const int64_t MAX_HISTORY_DAYS = 200 * 366;
+
+// Ids come from the ledger's currency column; anything out of range is treated as USD
+static size_t CurrencyIndex(uint8_t currency) {
+    return currency < CURRENCY_TYPE_COUNT ? currency : 0;
+}
 
 void CurrencyManager::ShowCurrencyDialog(HWND hwnd) {
     // Stub implementation
 }
+
+void CurrencyManager::SetUsdRates(const double unitsPerUsd[CURRENCY_TYPE_COUNT]) {
+    for (int to = 0; to < CURRENCY_TYPE_COUNT; ++to) {
+        for (int from = 0; from < CURRENCY_TYPE_COUNT; ++from) {
+            rates[to][from] = to == from ? 1.0 : unitsPerUsd[to] / unitsPerUsd[from];
+        }
+    }
+    ++ratesVersion;
+}
+
+double CurrencyManager::Rate(CurrencyType from, CurrencyType to) {
+    return rates[static_cast<int>(to)][static_cast<int>(from)];
+}
+
+const double* CurrencyManager::FactorsTo(CurrencyType target) {
+    return rates[static_cast<int>(target)];
+}
+
+void CurrencyManager::ConvertAmounts(std::span<const double> amounts, std::span<const uint8_t> currencies,
+    CurrencyType target, std::span<double> converted) {
+    const double* factors = FactorsTo(target);
+    size_t count = std::min({ amounts.size(), currencies.size(), converted.size() });
+    size_t i = 0;
+
+#ifdef CURRENCY_SSE2
+    for (; i + 2 <= count; i += 2) {
+        __m128d factor = _mm_set_pd(factors[CurrencyIndex(currencies[i + 1])], factors[CurrencyIndex(currencies[i])]);
+        _mm_storeu_pd(&converted[i], _mm_mul_pd(_mm_loadu_pd(&amounts[i]), factor));
+    }
+#endif
+    for (; i < count; ++i) {
+        converted[i] = amounts[i] * factors[CurrencyIndex(currencies[i])];
+    }
+}
+
+double CurrencyManager::SumConverted(std::span<const double> amounts, std::span<const uint8_t> currencies,
+    CurrencyType target) {
+    const double* factors = FactorsTo(target);
+    size_t count = std::min(amounts.size(), currencies.size());
+    size_t i = 0;
+    double total = 0.0;
+
+#ifdef CURRENCY_SSE2
+    // Two accumulators of two lanes each, so consecutive adds do not wait on each other
+    __m128d sumA = _mm_setzero_pd();
+    __m128d sumB = _mm_setzero_pd();
+    for (; i + 4 <= count; i += 4) {
+        __m128d factorA = _mm_set_pd(factors[CurrencyIndex(currencies[i + 1])], factors[CurrencyIndex(currencies[i])]);
+        __m128d factorB = _mm_set_pd(factors[CurrencyIndex(currencies[i + 3])], factors[CurrencyIndex(currencies[i + 2])]);
+        sumA = _mm_add_pd(sumA, _mm_mul_pd(_mm_loadu_pd(&amounts[i]), factorA));
+        sumB = _mm_add_pd(sumB, _mm_mul_pd(_mm_loadu_pd(&amounts[i + 2]), factorB));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, _mm_add_pd(sumA, sumB));
+    total = lanes[0] + lanes[1];
+#endif
+    for (; i < count; ++i) {
+        total += amounts[i] * factors[CurrencyIndex(currencies[i])];
+    }
+    return total;
+}
+
+// Row in effect on day; the history must not be empty
+static const DayRates& HistoryRow(int day) {
+    int64_t offset = static_cast<int64_t>(day) - firstHistoryDay;
+    int64_t last = static_cast<int64_t>(rateHistory.size()) - 1;
+    if (offset < 0) offset = day == INVALID_DAY ? last : 0;
+    return rateHistory[static_cast<size_t>(std::min(offset, last))];
+}
+
+// Parses a currency code, rejecting unknown ones rather than reading them as USD
+static bool ParseCurrencyCode(const std::wstring& field, int& currency) {
+    CurrencyType parsed = StringToCurrency(field);
+    if (CurrencyToString(parsed) != field) return false;
+    currency = static_cast<int>(parsed);
+    return true;
+}
+
+bool CurrencyManager::LoadRateHistory(const std::wstring& filePath) {
+    struct Quote {
+        int day;
+        int currency;
+        double unitsPerUsd;
+    };
+    std::vector<Quote> quotes;
+
+    try {
+        std::wifstream file(filePath);
+        if (!file.is_open()) {
+            return false;
+        }
+
+        std::wstring line;
+        while (std::getline(file, line)) {
+            std::vector<std::wstring> fields;
+            std::wstringstream fieldStream(line);
+            std::wstring field;
+            while (std::getline(fieldStream, field, L',')) {
+                fields.push_back(Trim(field));
+            }
+            if (fields.size() != 3 && fields.size() != 4) continue;
+
+            Quote quote;
+            quote.day = DateToDayNumber(fields[0]);
+            if (quote.day == INVALID_DAY) continue;
+
+            double rate = _wtof(fields.back().c_str());
+            if (!(rate > 0.0) || !std::isfinite(rate)) continue;
+
+            if (fields.size() == 3) {
+                if (!ParseCurrencyCode(fields[1], quote.currency)) continue;
+                quote.unitsPerUsd = rate;
+            }
+            else {
+                // One base buys rate quote; only pairs against USD are used
+                int base, counter;
+                if (!ParseCurrencyCode(fields[1], base) || !ParseCurrencyCode(fields[2], counter)) continue;
+                if (base == static_cast<int>(CurrencyType::USD)) {
+                    quote.currency = counter;
+                    quote.unitsPerUsd = rate;
+                }
+                else if (counter == static_cast<int>(CurrencyType::USD)) {
+                    quote.currency = base;
+                    quote.unitsPerUsd = 1.0 / rate;
+                }
+                else {
+                    continue;
+                }
+            }
+            if (quote.currency == static_cast<int>(CurrencyType::USD)) continue;
+            quotes.push_back(quote);
+        }
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+
+    if (quotes.empty()) {
+        LogError(L"No usable rates in " + filePath, L"CurrencyManager::LoadRateHistory");
+        return false;
+    }
+
+    std::stable_sort(quotes.begin(), quotes.end(),
+        [](const Quote& a, const Quote& b) { return a.day < b.day; });
+
+    int64_t span = static_cast<int64_t>(quotes.back().day) - quotes.front().day + 1;
+    if (span > MAX_HISTORY_DAYS) {
+        LogError(L"Rate history spans too many days: " + filePath, L"CurrencyManager::LoadRateHistory");
+        return false;
+    }
+
+    // Each currency starts from its earliest quote (or today's rate if it has
+    // none), then every day carries the previous one forward and applies the
+    // day's quotes; the last quote of a day wins
+    double current[CURRENCY_TYPE_COUNT];
+    for (int currency = 0; currency < CURRENCY_TYPE_COUNT; ++currency) {
+        current[currency] = rates[currency][static_cast<int>(CurrencyType::USD)];
+    }
+    bool seen[CURRENCY_TYPE_COUNT] = {};
+    for (const auto& quote : quotes) {
+        if (!seen[quote.currency]) {
+            current[quote.currency] = quote.unitsPerUsd;
+            seen[quote.currency] = true;
+        }
+    }
+
+    std::vector<DayRates> history(static_cast<size_t>(span));
+    size_t next = 0;
+    for (size_t offset = 0; offset < history.size(); ++offset) {
+        int day = quotes.front().day + static_cast<int>(offset);
+        for (; next < quotes.size() && quotes[next].day == day; ++next) {
+            current[quotes[next].currency] = quotes[next].unitsPerUsd;
+        }
+
+        DayRates& row = history[offset];
+        for (int currency = 0; currency < CURRENCY_TYPE_COUNT; ++currency) {
+            row.unitsPerUsd[currency] = current[currency];
+            row.usdPerUnit[currency] = 1.0 / current[currency];
+        }
+    }
+
+    rateHistory = std::move(history);
+    firstHistoryDay = quotes.front().day;
+    ++ratesVersion;
+
+    LogInfo(L"Loaded " + std::to_wstring(quotes.size()) + L" historical rates over "
+        + std::to_wstring(span) + L" days");
+    return true;
+}
+
+void CurrencyManager::ClearRateHistory() {
+    rateHistory.clear();
+    rateHistory.shrink_to_fit();
+    ++ratesVersion;
+}
+
+bool CurrencyManager::HasRateHistory() {
+    return !rateHistory.empty();
+}
+
+double CurrencyManager::RateOn(CurrencyType from, CurrencyType to, int day) {
+    if (rateHistory.empty() || from == to) return Rate(from, to);
+
+    const DayRates& row = HistoryRow(day);
+    return row.usdPerUnit[static_cast<int>(from)] * row.unitsPerUsd[static_cast<int>(to)];
+}
+
+void CurrencyManager::FactorsOn(CurrencyType target, int day, double factors[CURRENCY_TYPE_COUNT]) {
+    for (int from = 0; from < CURRENCY_TYPE_COUNT; ++from) {
+        factors[from] = RateOn(static_cast<CurrencyType>(from), target, day);
+    }
+}
+
+void CurrencyManager::ConvertAmountsOn(std::span<const double> amounts, std::span<const uint8_t> currencies,
+    std::span<const int32_t> days, CurrencyType target, std::span<double> converted) {
+    if (rateHistory.empty()) {
+        ConvertAmounts(amounts, currencies, target, converted);
+        return;
+    }
+
+    int to = static_cast<int>(target);
+    size_t count = std::min({ amounts.size(), currencies.size(), days.size(), converted.size() });
+    size_t i = 0;
+
+#ifdef CURRENCY_SSE2
+    for (; i + 2 <= count; i += 2) {
+        const DayRates& a = HistoryRow(days[i]);
+        const DayRates& b = HistoryRow(days[i + 1]);
+        __m128d toUsd = _mm_set_pd(b.usdPerUnit[CurrencyIndex(currencies[i + 1])], a.usdPerUnit[CurrencyIndex(currencies[i])]);
+        __m128d fromUsd = _mm_set_pd(b.unitsPerUsd[to], a.unitsPerUsd[to]);
+        _mm_storeu_pd(&converted[i], _mm_mul_pd(_mm_mul_pd(_mm_loadu_pd(&amounts[i]), toUsd), fromUsd));
+    }
+#endif
+    for (; i < count; ++i) {
+        const DayRates& row = HistoryRow(days[i]);
+        converted[i] = amounts[i] * row.usdPerUnit[CurrencyIndex(currencies[i])] * row.unitsPerUsd[to];
+    }
+}
+
+double CurrencyManager::SumConvertedOn(std::span<const double> amounts, std::span<const uint8_t> currencies,
+    std::span<const int32_t> days, CurrencyType target) {
+    if (rateHistory.empty()) return SumConverted(amounts, currencies, target);
+
+    int to = static_cast<int>(target);
+    size_t count = std::min({ amounts.size(), currencies.size(), days.size() });
+    size_t i = 0;
+    double total = 0.0;
+
+#ifdef CURRENCY_SSE2
+    __m128d sum = _mm_setzero_pd();
+    for (; i + 2 <= count; i += 2) {
+        const DayRates& a = HistoryRow(days[i]);
+        const DayRates& b = HistoryRow(days[i + 1]);
+        __m128d toUsd = _mm_set_pd(b.usdPerUnit[CurrencyIndex(currencies[i + 1])], a.usdPerUnit[CurrencyIndex(currencies[i])]);
+        __m128d fromUsd = _mm_set_pd(b.unitsPerUsd[to], a.unitsPerUsd[to]);
+        sum = _mm_add_pd(sum, _mm_mul_pd(_mm_mul_pd(_mm_loadu_pd(&amounts[i]), toUsd), fromUsd));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, sum);
+    total = lanes[0] + lanes[1];
+#endif
+    for (; i < count; ++i) {
+        const DayRates& row = HistoryRow(days[i]);
+        total += amounts[i] * row.usdPerUnit[CurrencyIndex(currencies[i])] * row.unitsPerUsd[to];
+    }
+    return total;
+}
+
+uint64_t CurrencyManager::RatesVersion() {
+    return ratesVersion;
+}
@@ -1,7 +1,63 @@
 #pragma once
 #include <windows.h>
+#include "DataStructures.h"
+#include <cstdint>
+#include <span>
+#include <string>
+
+// Units of each currency one USD buys, by currency id (simplified - in a
+// real app, fetched from an API)
+const double DEFAULT_USD_RATES[CURRENCY_TYPE_COUNT] = { 1.0, 0.85, 0.73, 110.0, 1.25, 1.35 };
+
+// Historical rates loaded at startup when present
+const wchar_t RATE_HISTORY_FILE[] = L"exchange_rates.csv";
 
 class CurrencyManager {
 public:
     static void ShowCurrencyDialog(HWND hwnd);
+
+    // Exchange rates live in a dense CURRENCY_TYPE_COUNT x CURRENCY_TYPE_COUNT
+    // matrix indexed by currency id, a few cache lines in all.
+    // Sets every pair from the units of each currency one USD buys.
+    static void SetUsdRates(const double unitsPerUsd[CURRENCY_TYPE_COUNT]);
+    static double Rate(CurrencyType from, CurrencyType to);
+
+    // Factors from every currency into target, indexed by currency id
+    static const double* FactorsTo(CurrencyType target);
+
+    // Batch kernels over parallel amount and currency columns (currency ids
+    // as stored in the ledger), two amounts per SSE2 step
+    static void ConvertAmounts(std::span<const double> amounts, std::span<const uint8_t> currencies,
+        CurrencyType target, std::span<double> converted);
+    static double SumConverted(std::span<const double> amounts, std::span<const uint8_t> currencies,
+        CurrencyType target);
+
+    // Rate history: one row of rates per day from the first to the last date
+    // loaded, days without a quote carrying the previous day's rates, so an
+    // as-of lookup is a subtraction and an index. Days before or after the
+    // table use its first or last row; undated rows (INVALID_DAY) use the
+    // last. Without history these fall back to the current rates above.
+    //
+    // CSV lines are "date,currency,units per USD" or "date,base,quote,rate"
+    // with USD on one side; other lines, such as a header, are skipped.
+    // Replaces any previous history. Returns false if the file cannot be read
+    // or holds no usable rate.
+    static bool LoadRateHistory(const std::wstring& filePath);
+    static void ClearRateHistory();
+    static bool HasRateHistory();
+
+    static double RateOn(CurrencyType from, CurrencyType to, int day);
+
+    // Factors from every currency into target on the given day
+    static void FactorsOn(CurrencyType target, int day, double factors[CURRENCY_TYPE_COUNT]);
+
+    // Batch kernels converting each amount at the rate of its own day
+    static void ConvertAmountsOn(std::span<const double> amounts, std::span<const uint8_t> currencies,
+        std::span<const int32_t> days, CurrencyType target, std::span<double> converted);
+    static double SumConvertedOn(std::span<const double> amounts, std::span<const uint8_t> currencies,
+        std::span<const int32_t> days, CurrencyType target);
+
+    // Changes whenever any rate is set or the history is replaced, so caches
+    // of converted figures can tell they are stale
+    static uint64_t RatesVersion();
 };
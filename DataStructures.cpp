@@ -1,26 +1,42 @@
 #include "DataStructures.h"
 #include "Utils.h"
+#include "Ledger.h"
+#include "LedgerTimeline.h"
+#include "QueryPlanner.h"
+#include "RollupCube.h"
 #include <algorithm>
 #include <random>
 #include <sstream>
 #include <iomanip>
 #include <chrono>
+#include <unordered_map>
+
+// Defined before the stores, so it outlives the records allocated from it
+static std::unique_ptr<std::pmr::monotonic_buffer_resource> recordArena;
 
 std::vector<User> users;
-std::vector<Expense> expenses;
-std::vector<Income> incomes;
+RecordStore<Expense> expenses;
+RecordStore<Income> incomes;
 std::vector<Budget> budgets;
 std::vector<SavingsGoal> savingsGoals;
 std::vector<Category> categories;
 std::vector<RecurringTransaction> recurringTransactions;
 // Global data containers
 
-std::map<CurrencyType, std::map<CurrencyType, double>> exchangeRates;
-
 // Current session
 std::wstring currentUserId;
 User* currentUser = nullptr;
 
+// Record arena; slabs start at 256 KB and grow geometrically
+std::pmr::memory_resource* RecordArena() {
+    if (!recordArena) ResetRecordArena();
+    return recordArena.get();
+}
+
+void ResetRecordArena() {
+    recordArena = std::make_unique<std::pmr::monotonic_buffer_resource>(256 * 1024);
+}
+
 
 
 // Category management functions
@@ -59,226 +75,137 @@ bool ValidateBudget(const Budget& budget) {
 
 
 // Search and filter functions
+// The planner settles every criterion from the indexes and columns; records
+// are only read to copy out the matches
 std::vector<Expense> FilterExpenses(const FilterCriteria& criteria, const std::wstring& userId) {
     std::vector<Expense> result;
-    
-    for (const auto& expense : expenses) {
-        if (!userId.empty() && expense.userId != userId) continue;
-        
-        // Date range filter
-        if (!IsDateInRange(expense.date, criteria.dateRange)) continue;
-        
-        // Category filter
-        if (!criteria.categories.empty()) {
-            bool categoryMatch = std::find(criteria.categories.begin(), criteria.categories.end(), 
-                expense.category) != criteria.categories.end();
-            if (!categoryMatch) continue;
-        }
-        
-        // Amount range filter
-        if (expense.amount < criteria.minAmount || expense.amount > criteria.maxAmount) continue;
-        
-        // Tags filter
-        if (!criteria.tags.empty()) {
-            bool tagMatch = false;
-            for (const auto& tag : criteria.tags) {
-                if (std::find(expense.tags.begin(), expense.tags.end(), tag) != expense.tags.end()) {
-                    tagMatch = true;
-                    break;
-                }
-            }
-            if (!tagMatch) continue;
-        }
-        
-        // Search text filter
-        if (!criteria.searchText.empty()) {
-            std::wstring searchLower = criteria.searchText;
-            std::transform(searchLower.begin(), searchLower.end(), searchLower.begin(), ::towlower);
-            
-            std::wstring categoryLower = expense.category;
-            std::transform(categoryLower.begin(), categoryLower.end(), categoryLower.begin(), ::towlower);
-            
-            std::wstring noteLower = expense.note;
-            std::transform(noteLower.begin(), noteLower.end(), noteLower.begin(), ::towlower);
-            
-            bool textMatch = categoryLower.find(searchLower) != std::wstring::npos ||
-                           noteLower.find(searchLower) != std::wstring::npos;
-            
-            for (const auto& tag : expense.tags) {
-                std::wstring tagLower = tag;
-                std::transform(tagLower.begin(), tagLower.end(), tagLower.begin(), ::towlower);
-                if (tagLower.find(searchLower) != std::wstring::npos) {
-                    textMatch = true;
-                    break;
-                }
-            }
-            
-            if (!textMatch) continue;
-        }
-        
-        result.push_back(expense);
+
+    QueryPlan plan(criteria, userId, false);
+    for (uint32_t row : plan.Execute()) {
+        result.push_back(ledger.Row(row).GetExpense());
     }
-    
+    if (traceQueryPlans) LogInfo(plan.Explain());
+
     return result;
 }
 
 std::vector<Income> FilterIncomes(const FilterCriteria& criteria, const std::wstring& userId) {
     std::vector<Income> result;
-    
-    for (const auto& income : incomes) {
-        if (!userId.empty() && income.userId != userId) continue;
-        
-        // Date range filter
-        if (!IsDateInRange(income.date, criteria.dateRange)) continue;
-        
-        // Amount range filter
-        if (income.amount < criteria.minAmount || income.amount > criteria.maxAmount) continue;
-        
-        // Tags filter
-        if (!criteria.tags.empty()) {
-            bool tagMatch = false;
-            for (const auto& tag : criteria.tags) {
-                if (std::find(income.tags.begin(), income.tags.end(), tag) != income.tags.end()) {
-                    tagMatch = true;
-                    break;
-                }
-            }
-            if (!tagMatch) continue;
-        }
-        
-        // Search text filter
-        if (!criteria.searchText.empty()) {
-            std::wstring searchLower = criteria.searchText;
-            std::transform(searchLower.begin(), searchLower.end(), searchLower.begin(), ::towlower);
-            
-            std::wstring sourceLower = income.source;
-            std::transform(sourceLower.begin(), sourceLower.end(), sourceLower.begin(), ::towlower);
-            
-            std::wstring noteLower = income.note;
-            std::transform(noteLower.begin(), noteLower.end(), noteLower.begin(), ::towlower);
-            
-            bool textMatch = sourceLower.find(searchLower) != std::wstring::npos ||
-                           noteLower.find(searchLower) != std::wstring::npos;
-            
-            for (const auto& tag : income.tags) {
-                std::wstring tagLower = tag;
-                std::transform(tagLower.begin(), tagLower.end(), tagLower.begin(), ::towlower);
-                if (tagLower.find(searchLower) != std::wstring::npos) {
-                    textMatch = true;
-                    break;
-                }
-            }
-            
-            if (!textMatch) continue;
-        }
-        
-        result.push_back(income);
+
+    QueryPlan plan(criteria, userId, true);
+    for (uint32_t row : plan.Execute()) {
+        result.push_back(ledger.Row(row).GetIncome());
     }
-    
+    if (traceQueryPlans) LogInfo(plan.Explain());
+
     return result;
 }
 
 // Analytics helper functions
+// Walks the rows in the date range and tallies expenses by category id
+static std::unordered_map<SymbolId, CategoryTally> TallyCategories(const std::wstring& userId, const DateRange& dateRange) {
+    std::unordered_map<SymbolId, CategoryTally> tallies;
+
+    SymbolId userSymbol = SymbolTable::Find(userId);
+    if (!userId.empty() && userSymbol == INVALID_SYMBOL) return tallies;
+
+    DayRange days = ToDayRange(dateRange);
+    auto candidates = userId.empty() ? ledgerTimeline.Range(days) : userTimeline.Range(userSymbol, days);
+    auto amountColumn = ledger.Amounts();
+    auto categoryColumn = ledger.Categories();
+    auto flagColumn = ledger.Flags();
+
+    for (const auto& entry : candidates) {
+        if (flagColumn[entry.row] & LEDGER_INCOME) continue;
+
+        CategoryTally& tally = tallies[categoryColumn[entry.row]];
+        tally.total += amountColumn[entry.row];
+        ++tally.count;
+    }
+
+    return tallies;
+}
+
 std::map<std::wstring, double> GetCategoryTotals(const std::wstring& userId, const DateRange& dateRange) {
     std::map<std::wstring, double> totals;
-    
-    FilterCriteria criteria;
-    criteria.dateRange = dateRange;
-    
-    auto filteredExpenses = FilterExpenses(criteria, userId);
-    
-    for (const auto& expense : filteredExpenses) {
-        totals[expense.category] += expense.amount;
+
+    // Names are only resolved for the final result
+    for (const auto& pair : TallyCategories(userId, dateRange)) {
+        totals[std::wstring(SymbolTable::Resolve(pair.first))] = pair.second.total;
     }
-    
+
     return totals;
 }
 
 
 std::vector<SpendingTrend> GetSpendingTrends(const std::wstring& userId, const std::wstring& period) {
     std::vector<SpendingTrend> trends;
-    
+
     // Implementation depends on period type (monthly, weekly, etc.)
     // This is a simplified version for monthly trends
-    
-    std::map<std::wstring, SpendingTrend> monthlyTrends;
-    
-    // Process expenses
-    for (const auto& expense : expenses) {
-        if (expense.userId != userId) continue;                      
-        
-        // Extract year-month from date (YYYY-MM-DD -> YYYY-MM)
-        std::wstring monthKey = expense.date.substr(0, 7);
-        
-        if (monthlyTrends.find(monthKey) == monthlyTrends.end()) {
-            monthlyTrends[monthKey] = SpendingTrend();
-            monthlyTrends[monthKey].period = monthKey;
-        }
-        
-        monthlyTrends[monthKey].totalExpenses += expense.amount;
-        monthlyTrends[monthKey].categoryBreakdown[expense.category] += expense.amount;
-    }
-    
-    // Process incomes
-    for (const auto& income : incomes) {
-        if (income.userId != userId) continue;
-        
-        std::wstring monthKey = income.date.substr(0, 7);
-        
-        if (monthlyTrends.find(monthKey) == monthlyTrends.end()) {
-            monthlyTrends[monthKey] = SpendingTrend();
-            monthlyTrends[monthKey].period = monthKey;
+    SymbolId userSymbol = SymbolTable::Find(userId);
+    if (userSymbol == INVALID_SYMBOL) return trends;
+
+    // Read from the monthly rollup, which is already in period order
+    for (const auto& [monthIndex, cells] : rollupCube.Months(userSymbol)) {
+        SpendingTrend trend = SpendingTrend();
+        trend.period = MonthIndexToKey(monthIndex);
+
+        for (const auto& cell : cells) {
+            if (cell.income) {
+                trend.totalIncome += cell.sum;
+            }
+            else {
+                trend.totalExpenses += cell.sum;
+                trend.categoryBreakdown[std::wstring(SymbolTable::Resolve(cell.category))] += cell.sum;
+            }
         }
-        
-        monthlyTrends[monthKey].totalIncome += income.amount;
-    }
-    
-    // Calculate balances and convert to vector
-    for (auto& trend : monthlyTrends) {
-        trend.second.balance = trend.second.totalIncome - trend.second.totalExpenses;
-        trends.push_back(trend.second);
+
+        trend.balance = trend.totalIncome - trend.totalExpenses;
+        trends.push_back(std::move(trend));
     }
-    
-    // Sort by period
-    std::sort(trends.begin(), trends.end(), 
-        [](const SpendingTrend& a, const SpendingTrend& b) {
-            return a.period < b.period;
-        });
-    
+
     return trends;
 }
 
+// Totals and transaction counts come from one walk of the user's timeline
 std::vector<CategoryAnalytics> GetCategoryAnalytics(const std::wstring& userId, const DateRange& dateRange) {
+    std::map<std::wstring, CategoryTally> tallies;
+    for (const auto& pair : TallyCategories(userId, dateRange)) {
+        tallies[std::wstring(SymbolTable::Resolve(pair.first))] = pair.second;
+    }
+
+    std::vector<Budget> userBudgets;
+    std::copy_if(budgets.begin(), budgets.end(), std::back_inserter(userBudgets),
+        [&](const Budget& b) { return b.userId == userId; });
+
+    return BuildCategoryAnalytics(tallies, userBudgets);
+}
+
+std::vector<CategoryAnalytics> BuildCategoryAnalytics(const std::map<std::wstring, CategoryTally>& tallies, const std::vector<Budget>& userBudgets) {
     std::vector<CategoryAnalytics> analytics;
     
-    auto categoryTotals = GetCategoryTotals(userId, dateRange);
     double totalSpent = 0.0;
     
-    for (const auto& pair : categoryTotals) {
-        totalSpent += pair.second;
+    for (const auto& pair : tallies) {
+        totalSpent += pair.second.total;
     }
     
-    for (const auto& pair : categoryTotals) {
+    for (const auto& pair : tallies) {
         CategoryAnalytics cat;
         cat.category = pair.first;
-        cat.totalSpent = pair.second;
-        cat.percentageOfTotal = totalSpent > 0 ? (pair.second / totalSpent) * 100.0 : 0.0;
+        cat.totalSpent = pair.second.total;
+        cat.percentageOfTotal = totalSpent > 0 ? (pair.second.total / totalSpent) * 100.0 : 0.0;
         
         // Find budget for this category
-        auto budgetIt = std::find_if(budgets.begin(), budgets.end(),
-            [&](const Budget& b) { return b.userId == userId && b.category == pair.first && b.isActive; });
+        auto budgetIt = std::find_if(userBudgets.begin(), userBudgets.end(),
+            [&](const Budget& b) { return b.category == pair.first && b.isActive; });
         
-        if (budgetIt != budgets.end()) {
+        if (budgetIt != userBudgets.end()) {
             cat.budgetLimit = budgetIt->monthlyLimit;
         }
         
-        // Count transactions
-        FilterCriteria criteria;
-        criteria.dateRange = dateRange;
-        criteria.categories = {pair.first};
-        auto categoryExpenses = FilterExpenses(criteria, userId);
-        
-        cat.transactionCount = static_cast<int>(categoryExpenses.size());
+        cat.transactionCount = pair.second.count;
         cat.averageTransaction = cat.transactionCount > 0 ? cat.totalSpent / cat.transactionCount : 0.0;
         
         // Simple trend analysis (compare with previous period)
@@ -370,7 +297,8 @@ void ProcessRecurringTransaction(RecurringTransaction& rt) {
         expense.date = GetCurrentDate();
         
         if (ValidateExpense(expense)) {
-            expenses.push_back(expense);
+            InternSymbols(expense);
+            ledger.AddExpense(expenses.Insert(expense).index);
             UpdateBudgetSpending(rt.userId, rt.category, rt.amount);
         }
     } else {
@@ -383,7 +311,8 @@ void ProcessRecurringTransaction(RecurringTransaction& rt) {
         income.date = GetCurrentDate();
         
         if (ValidateIncome(income)) {
-            incomes.push_back(income);
+            InternSymbols(income);
+            ledger.AddIncome(incomes.Insert(income).index);
         }
     }
     
@@ -9,6 +9,10 @@
 #include <string>
 #include <map>
 #include <memory>
+#include <memory_resource>
+
+#include "SymbolTable.h"
+#include "SlotMap.h"
 
 
 // Forward declarations
@@ -25,6 +29,7 @@ enum class TransactionType { EXPENSE, INCOME };
 enum class RecurrenceType { DAILY, WEEKLY, MONTHLY, YEARLY };
 enum class AuthType { NONE, PIN, PASSWORD };
 enum class CurrencyType { USD, EUR, GBP, JPY, CAD, AUD };
+const int CURRENCY_TYPE_COUNT = static_cast<int>(CurrencyType::AUD) + 1;
 
 // Core data structures
 struct User {
@@ -66,35 +71,59 @@ struct Category {
     }
 };
 
+// Strings and tag lists of expense and income records. A record built with a
+// memory resource allocates its payload from it, so records loaded together
+// share one arena (see RecordArena); copies use the default heap.
+using RecordString = std::pmr::wstring;
+using RecordTags = std::pmr::vector<RecordString>;
+
 struct Expense {
-    std::wstring id;
-    std::wstring userId;
-    std::wstring category;
+    RecordString id;
+    RecordString userId;
+    RecordString category;
     double amount;
-    std::wstring note;
-    std::wstring date;
-    std::vector<std::wstring> tags;
-    std::wstring receiptPath;
+    RecordString note;
+    RecordString date;
+    RecordTags tags;
+    RecordString receiptPath;
     CurrencyType currency;
     double exchangeRate;  // To default currency
-    std::wstring location;
-
-    Expense() : amount(0.0), currency(CurrencyType::USD), exchangeRate(1.0) {}
+    RecordString location;
+
+    // Interned ids of userId, category and tags (kept in sync by InternSymbols)
+    SymbolId userSymbol;
+    SymbolId categorySymbol;
+    std::pmr::vector<SymbolId> tagSymbols;
+
+    Expense() : Expense(std::pmr::get_default_resource()) {}
+    explicit Expense(std::pmr::memory_resource* resource)
+        : id(resource), userId(resource), category(resource), amount(0.0), note(resource), date(resource),
+        tags(resource), receiptPath(resource), currency(CurrencyType::USD), exchangeRate(1.0), location(resource),
+        userSymbol(EMPTY_SYMBOL), categorySymbol(EMPTY_SYMBOL), tagSymbols(resource) {}
 };
 
 struct Income {
-    std::wstring id;
-    std::wstring userId;
-    std::wstring source;
+    RecordString id;
+    RecordString userId;
+    RecordString source;
     double amount;
-    std::wstring note;
-    std::wstring date;
-    std::vector<std::wstring> tags;
+    RecordString note;
+    RecordString date;
+    RecordTags tags;
     CurrencyType currency;
     double exchangeRate;
     bool isTaxable;
 
-    Income() : amount(0.0), currency(CurrencyType::USD), exchangeRate(1.0), isTaxable(true) {}
+    // Interned ids of userId, source and tags (kept in sync by InternSymbols)
+    SymbolId userSymbol;
+    SymbolId sourceSymbol;
+    std::pmr::vector<SymbolId> tagSymbols;
+
+    Income() : Income(std::pmr::get_default_resource()) {}
+    explicit Income(std::pmr::memory_resource* resource)
+        : id(resource), userId(resource), source(resource), amount(0.0), note(resource), date(resource),
+        tags(resource), currency(CurrencyType::USD), exchangeRate(1.0), isTaxable(true),
+        userSymbol(EMPTY_SYMBOL), sourceSymbol(EMPTY_SYMBOL), tagSymbols(resource) {}
 };
 
 struct Budget {
@@ -196,6 +225,12 @@ struct CategoryAnalytics {
     std::wstring trend;  // "increasing", "decreasing", "stable"
 };
 
+// One category's share of a user's expenses, in stored amounts
+struct CategoryTally {
+    double total = 0.0;
+    int count = 0;
+};
+
 // Constants
 const std::vector<Category> DEFAULT_CATEGORIES = {
     {L"Food & Dining", L"#FF6B6B", L"🍽️", true},
@@ -215,19 +250,33 @@ const std::vector<std::wstring> DEFAULT_INCOME_SOURCES = {
 
 // Global data containers
 extern std::vector<User> users;
-// In DataStructures.h
-extern std::vector<Expense> expenses;
-extern std::vector<Income> incomes;
+// Slot-map stores: handles stay valid across inserts, ids resolve in O(1)
+extern RecordStore<Expense> expenses;
+extern RecordStore<Income> incomes;
+
+// Arena for the payloads of bulk-loaded records. A load clears the stores and
+// starts a new arena, so the previous load's strings and tags are freed in one
+// release instead of one free each; imports append to the current arena.
+// Records added or replaced one at a time use the default heap.
+std::pmr::memory_resource* RecordArena();
+void ResetRecordArena();   // No stored record may still use the current arena
 
 extern std::vector<Budget> budgets;
 extern std::vector<RecurringTransaction> recurringTransactions;
 extern std::vector<SavingsGoal> savingsGoals;
 extern std::vector<Category> categories;
-extern std::map<CurrencyType, std::map<CurrencyType, double>> exchangeRates;
 
 // Current session
 extern std::wstring currentUserId;
 extern User* currentUser;
 
+// Search and filter functions; an empty userId matches every user
+std::vector<Expense> FilterExpenses(const FilterCriteria& criteria, const std::wstring& userId);
+std::vector<Income> FilterIncomes(const FilterCriteria& criteria, const std::wstring& userId);
+
+// Category analytics from per-category tallies of a user's expenses and that
+// user's budgets, largest total first
+std::vector<CategoryAnalytics> BuildCategoryAnalytics(const std::map<std::wstring, CategoryTally>& tallies, const std::vector<Budget>& userBudgets);
+
 
 #endif
\ No newline at end of file
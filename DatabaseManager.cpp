@@ -6,6 +6,9 @@
 #include "DatabaseManager.h"
 #include "DataStructures.h"
 #include "Utils.h"
+#include "Ledger.h"
+#include "LedgerTimeline.h"
+#include "CurrencyManager.h"
 #include <fstream>
 #include <string>
 #include <sstream>
@@ -43,18 +46,10 @@ User* DatabaseManager::GetUserByUsername(const std::wstring& username) {
     return nullptr; // TODO: implement
 }
 
-std::wstring DatabaseManager::TagsToString(const std::vector<std::wstring>& tags) {
+std::wstring DatabaseManager::TagsToString(const RecordTags& tags) {
     return L""; // TODO: implement
 }
 
-std::wstring DatabaseManager::StringToWString(const std::wstring& str) {
-    return str; // likely incorrect signature, adjust if needed
-}
-
-std::wstring DatabaseManager::WStringToString(const std::wstring& wstr) {
-    return wstr; // likely incorrect signature, adjust if needed
-}
-
 // Static member initialization
 const std::wstring DatabaseManager::DATA_FILE = L"finance_data.json";
 const std::wstring DatabaseManager::BACKUP_DIR = L"backups";
@@ -65,21 +60,6 @@ UINT_PTR DatabaseManager::backupTimerId = 0;
 int DatabaseManager::backupInterval = 30;
 HANDLE DatabaseManager::fileLock = INVALID_HANDLE_VALUE;
 
-std::string WStringToString(const std::wstring& wstr) {
-    if (wstr.empty()) return std::string();
-    int size_needed = WideCharToMultiByte(CP_UTF8, 0, &wstr[0], (int)wstr.size(), NULL, 0, NULL, NULL);
-    std::string strTo(size_needed, 0);
-    WideCharToMultiByte(CP_UTF8, 0, &wstr[0], (int)wstr.size(), &strTo[0], size_needed, NULL, NULL);
-    return strTo;
-}
-
-std::wstring StringToWString(const std::string& str) {
-    if (str.empty()) return std::wstring();
-    int size_needed = MultiByteToWideChar(CP_UTF8, 0, &str[0], (int)str.size(), NULL, 0);
-    std::wstring wstrTo(size_needed, 0);
-    MultiByteToWideChar(CP_UTF8, 0, &str[0], (int)str.size(), &wstrTo[0], size_needed);
-    return wstrTo;
-}
 // In DatabaseManager.cpp
 nlohmann::json DatabaseManager::BudgetToJson(const Budget& budget) {
     nlohmann::json j;
@@ -213,10 +193,11 @@ bool DatabaseManager::LoadAllData() {
         file >> root;
         file.close();
 
-        // Clear existing data
+        // Clear existing data; the old records' text goes with the old arena
         users.clear();
         expenses.clear();
         incomes.clear();
+        ResetRecordArena();
         budgets.clear();
         recurringTransactions.clear();
         savingsGoals.clear();
@@ -231,17 +212,20 @@ bool DatabaseManager::LoadAllData() {
 
         // Load expenses
         if (root.contains("expenses")) {
+            expenses.reserve(root["expenses"].size());
             for (const auto& expenseJson : root["expenses"]) {
-                expenses.push_back(JsonToExpense(expenseJson));
+                expenses.Insert(JsonToExpense(expenseJson, RecordArena()));
             }
         }
 
         // Load incomes
         if (root.contains("incomes")) {
+            incomes.reserve(root["incomes"].size());
             for (const auto& incomeJson : root["incomes"]) {
-                incomes.push_back(JsonToIncome(incomeJson));
+                incomes.Insert(JsonToIncome(incomeJson, RecordArena()));
             }
         }
+        ledger.Rebuild();
 
         // Load budgets
         if (root.contains("budgets")) {
@@ -282,6 +266,7 @@ bool DatabaseManager::LoadAllData() {
         ReleaseFileLock();
         // On error, initialize with default data
         InitializeDefaultData();
+        ledger.Rebuild(); // Records may have been partially loaded
         return false;
     }
 }
@@ -338,7 +323,7 @@ bool DatabaseManager::ExportToCSV(const std::wstring& filePath, const std::wstri
         file << L"Date,Category,Amount,Note,Tags,Currency,Location" << std::endl;
 
         for (const auto& expense : expenses) {
-            if (!userId.empty() && expense.userId != userId) continue;
+            if (!userId.empty() && std::wstring_view(expense.userId) != userId) continue;
 
             file << EscapeCSVField(expense.date) << L","
                 << EscapeCSVField(expense.category) << L","
@@ -356,7 +341,7 @@ bool DatabaseManager::ExportToCSV(const std::wstring& filePath, const std::wstri
         file << L"Date,Source,Amount,Note,Tags,Currency,Taxable" << std::endl;
 
         for (const auto& income : incomes) {
-            if (!userId.empty() && income.userId != userId) continue;
+            if (!userId.empty() && std::wstring_view(income.userId) != userId) continue;
 
             file << EscapeCSVField(income.date) << L","
                 << EscapeCSVField(income.source) << L","
@@ -404,24 +389,48 @@ bool DatabaseManager::ExportToPDF(const std::wstring& filePath, const std::wstri
         file << L"======================" << std::endl;
         file << L"Generated: " << GetCurrentDateTime() << std::endl << std::endl;
 
-        // Summary
+        // Summary, in the user's currency (USD for everyone) with every row
+        // revalued at the rate on its own date
+        SymbolId userSymbol = SymbolTable::Find(userId);
+        User* user = userId.empty() ? nullptr : GetUserByUsername(userId);
+        CurrencyType reportCurrency = user ? user->defaultCurrency : CurrencyType::USD;
+
+        auto flagColumn = ledger.Flags();
         double totalIncome = 0.0, totalExpenses = 0.0;
-        for (const auto& income : incomes) {
-            if (userId.empty() || income.userId == userId) {
-                totalIncome += income.amount;
-            }
-        }
+        if (userId.empty()) {
+            // Every row counts, so the whole columns are converted in one pass
+            std::vector<double> converted(ledger.Size());
+            CurrencyManager::ConvertAmountsOn(ledger.Amounts(), ledger.Currencies(), ledger.Days(),
+                reportCurrency, converted);
 
-        for (const auto& expense : expenses) {
-            if (userId.empty() || expense.userId == userId) {
-                totalExpenses += expense.amount;
+            ledger.ForEachRow([&](size_t row) {
+                if (flagColumn[row] & LEDGER_INCOME) totalIncome += converted[row];
+                else totalExpenses += converted[row];
+            });
+        }
+        else {
+            // Only the user's rows, read from their timeline and gathered into
+            // contiguous columns per kind for the conversion kernel
+            auto amountColumn = ledger.Amounts();
+            auto currencyColumn = ledger.Currencies();
+            std::vector<double> amounts[2];        // Expenses, incomes
+            std::vector<uint8_t> currencies[2];
+            std::vector<int32_t> days[2];
+            for (const auto& entry : userTimeline.Range(userSymbol, DayRange())) {
+                int kind = (flagColumn[entry.row] & LEDGER_INCOME) ? 1 : 0;
+                amounts[kind].push_back(amountColumn[entry.row]);
+                currencies[kind].push_back(currencyColumn[entry.row]);
+                days[kind].push_back(entry.day);
             }
+            totalExpenses = CurrencyManager::SumConvertedOn(amounts[0], currencies[0], days[0], reportCurrency);
+            totalIncome = CurrencyManager::SumConvertedOn(amounts[1], currencies[1], days[1], reportCurrency);
         }
 
-        file << L"FINANCIAL SUMMARY" << std::endl;
-        file << L"Total Income: $" << std::fixed << std::setprecision(2) << totalIncome << std::endl;
-        file << L"Total Expenses: $" << std::fixed << std::setprecision(2) << totalExpenses << std::endl;
-        file << L"Balance: $" << std::fixed << std::setprecision(2) << (totalIncome - totalExpenses) << std::endl;
+        std::wstring currencyCode = CurrencyToString(reportCurrency);
+        file << L"FINANCIAL SUMMARY (" << currencyCode << L", at each transaction's date rate)" << std::endl;
+        file << L"Total Income: " << std::fixed << std::setprecision(2) << totalIncome << L" " << currencyCode << std::endl;
+        file << L"Total Expenses: " << std::fixed << std::setprecision(2) << totalExpenses << L" " << currencyCode << std::endl;
+        file << L"Balance: " << std::fixed << std::setprecision(2) << (totalIncome - totalExpenses) << L" " << currencyCode << std::endl;
         file << std::endl;
 
         // Recent transactions
@@ -429,15 +438,20 @@ bool DatabaseManager::ExportToPDF(const std::wstring& filePath, const std::wstri
         file << L"Date       Category         Amount    Note" << std::endl;
         file << L"----       --------         ------    ----" << std::endl;
 
+        // Store order is not insertion order, so walk the timeline newest
+        // first, the user's own when the report is for one user
+        auto timeline = userId.empty() ? ledgerTimeline.Range(DayRange()) : userTimeline.Range(userSymbol, DayRange());
         int count = 0;
-        for (auto it = expenses.rbegin(); it != expenses.rend() && count < 10; ++it) {
-            if (userId.empty() || it->userId == userId) {
-                file << std::left << std::setw(11) << it->date
-                    << std::setw(17) << it->category
-                    << L"$" << std::right << std::setw(8) << std::fixed << std::setprecision(2) << it->amount
-                    << L"  " << it->note << std::endl;
-                count++;
-            }
+        for (auto it = timeline.rbegin(); it != timeline.rend() && count < 10; ++it) {
+            LedgerRow row = ledger.Row(it->row);
+            if (row.IsIncome()) continue;
+
+            const Expense& expense = row.GetExpense();
+            file << std::left << std::setw(11) << expense.date
+                << std::setw(17) << expense.category
+                << L"$" << std::right << std::setw(8) << std::fixed << std::setprecision(2) << expense.amount
+                << L"  " << expense.note << std::endl;
+            count++;
         }
 
         file.close();
@@ -481,7 +495,7 @@ bool DatabaseManager::ImportFromCSV(const std::wstring& filePath, const std::wst
             auto fields = ParseCSVLine(line);
 
             if (section == L"EXPENSES" && fields.size() >= 4) {
-                Expense expense;
+                Expense expense(RecordArena());
                 expense.id = GenerateUniqueId();
                 expense.userId = userId;
                 expense.date = fields[0];
@@ -494,11 +508,12 @@ bool DatabaseManager::ImportFromCSV(const std::wstring& filePath, const std::wst
                 if (fields.size() > 6) expense.location = fields[6];
 
                 if (ValidateExpense(expense)) {
-                    expenses.push_back(expense);
+                    InternSymbols(expense);
+                    expenses.Insert(std::move(expense));
                 }
             }
             else if (section == L"INCOMES" && fields.size() >= 4) {
-                Income income;
+                Income income(RecordArena());
                 income.id = GenerateUniqueId();
                 income.userId = userId;
                 income.date = fields[0];
@@ -511,15 +526,18 @@ bool DatabaseManager::ImportFromCSV(const std::wstring& filePath, const std::wst
                 if (fields.size() > 6) income.isTaxable = (fields[6] == L"Yes");
 
                 if (ValidateIncome(income)) {
-                    incomes.push_back(income);
+                    InternSymbols(income);
+                    incomes.Insert(std::move(income));
                 }
             }
         }
+        ledger.Rebuild();
 
         file.close();
         return SaveAllData();
     }
     catch (const std::exception&) {
+        ledger.Rebuild(); // Rows imported before the error
         return false;
     }
 }
@@ -547,16 +565,19 @@ bool DatabaseManager::ImportFromJSON(const std::wstring& filePath) {
 
         // Import other data (append)
         if (importData.contains("expenses")) {
+            expenses.reserve(expenses.size() + importData["expenses"].size());
             for (const auto& expenseJson : importData["expenses"]) {
-                expenses.push_back(JsonToExpense(expenseJson));
+                expenses.Insert(JsonToExpense(expenseJson, RecordArena()));
             }
         }
 
         if (importData.contains("incomes")) {
+            incomes.reserve(incomes.size() + importData["incomes"].size());
             for (const auto& incomeJson : importData["incomes"]) {
-                incomes.push_back(JsonToIncome(incomeJson));
+                incomes.Insert(JsonToIncome(incomeJson, RecordArena()));
             }
         }
+        ledger.Rebuild();
 
         if (importData.contains("budgets")) {
             for (const auto& budgetJson : importData["budgets"]) {
@@ -599,43 +620,43 @@ bool DatabaseManager::ValidateDatabase() {
     std::vector<std::wstring> issues;
 
     // Check for duplicate IDs
-    std::set<std::wstring> expenseIds, incomeIds, budgetIds, goalIds, recurringIds;
+    std::set<std::wstring_view> expenseIds, incomeIds, budgetIds, goalIds, recurringIds;
 
     for (const auto& expense : expenses) {
         if (expenseIds.count(expense.id)) {
-            issues.push_back(L"Duplicate expense ID: " + expense.id);
+            issues.push_back(L"Duplicate expense ID: " + std::wstring(expense.id));
         }
         else {
             expenseIds.insert(expense.id);
         }
 
         if (!ValidateExpense(expense)) {
-            issues.push_back(L"Invalid expense data: " + expense.id);
+            issues.push_back(L"Invalid expense data: " + std::wstring(expense.id));
         }
     }
 
     for (const auto& income : incomes) {
         if (incomeIds.count(income.id)) {
-            issues.push_back(L"Duplicate income ID: " + income.id);
+            issues.push_back(L"Duplicate income ID: " + std::wstring(income.id));
         }
         else {
             incomeIds.insert(income.id);
         }
 
         if (!ValidateIncome(income)) {
-            issues.push_back(L"Invalid income data: " + income.id);
+            issues.push_back(L"Invalid income data: " + std::wstring(income.id));
         }
     }
 
     // Check user references
-    std::set<std::wstring> userIds;
+    std::set<std::wstring_view> userIds;
     for (const auto& user : users) {
         userIds.insert(user.username);
     }
 
     for (const auto& expense : expenses) {
         if (!userIds.count(expense.userId)) {
-            issues.push_back(L"Expense references non-existent user: " + expense.userId);
+            issues.push_back(L"Expense references non-existent user: " + std::wstring(expense.userId));
         }
     }
 
@@ -646,24 +667,19 @@ bool DatabaseManager::RepairDatabase() {
     bool repaired = false;
 
     // Remove invalid entries
-    auto originalExpenseCount = expenses.size();
-    expenses.erase(std::remove_if(expenses.begin(), expenses.end(),
-        [](const Expense& e) { return !ValidateExpense(e); }), expenses.end());
-
-    if (expenses.size() != originalExpenseCount) {
-        repaired = true;
-    }
-
-    auto originalIncomeCount = incomes.size();
-    incomes.erase(std::remove_if(incomes.begin(), incomes.end(),
-        [](const Income& i) { return !ValidateIncome(i); }), incomes.end());
-
-    if (incomes.size() != originalIncomeCount) {
+    auto badExpenses = expenses.FindSlots([](const Expense& e) { return !ValidateExpense(e); });
+    auto badIncomes = incomes.FindSlots([](const Income& i) { return !ValidateIncome(i); });
+
+    if (!badExpenses.empty() || !badIncomes.empty()) {
+        ledger.RemoveExpenses(badExpenses);
+        ledger.RemoveIncomes(badIncomes);
+        expenses.EraseSlots(badExpenses);
+        incomes.EraseSlots(badIncomes);
         repaired = true;
     }
 
     // Fix duplicate IDs
-    std::set<std::wstring> usedIds;
+    std::set<std::wstring_view> usedIds;
     for (auto& expense : expenses) {
         if (usedIds.count(expense.id) || expense.id.empty()) {
             expense.id = GenerateUniqueId();
@@ -681,6 +697,8 @@ bool DatabaseManager::RepairDatabase() {
     }
 
     if (repaired) {
+        expenses.RebuildIdIndex();
+        incomes.RebuildIdIndex();
         SaveAllData();
     }
 
@@ -743,6 +761,32 @@ std::wstring DatabaseManager::GetExportDirectory() {
     return std::wstring(currentDir) + L"\\" + EXPORT_DIR;
 }
 
+// Repeated values (user ids, categories, sources, tags, currency codes) are
+// read through the symbol table, which keeps both encodings of every distinct
+// value. Records are written from their own fields, not their cached symbol
+// ids, so a record edited without InternSymbols still saves what it shows.
+static SymbolId InternJsonString(const json& value) {
+    return SymbolTable::InternUtf8(value.get_ref<const std::string&>());
+}
+
+static std::string SymbolToJsonString(SymbolId id) {
+    return std::string(SymbolTable::ResolveUtf8(id));
+}
+
+static std::string CurrencyToJsonString(CurrencyType currency) {
+    return SymbolToJsonString(SymbolTable::Intern(CurrencyToString(currency)));
+}
+
+// Decodes straight into the record's field, which allocates from the record's
+// memory resource
+static void ReadJsonString(const json& value, RecordString& field) {
+    StringToWString(value.get_ref<const std::string&>(), field);
+}
+
+static CurrencyType JsonToCurrency(const json& value) {
+    return StringToCurrency(std::wstring(SymbolTable::Resolve(InternJsonString(value))));
+}
+
 // JSON conversion functions
 json DatabaseManager::UserToJson(const User& user) {
     json j;
@@ -779,7 +823,7 @@ json DatabaseManager::ExpenseToJson(const Expense& expense) {
     j["note"] = WStringToString(expense.note);
     j["date"] = WStringToString(expense.date);
     j["receiptPath"] = WStringToString(expense.receiptPath);
-    j["currency"] = WStringToString(CurrencyToString(expense.currency));
+    j["currency"] = CurrencyToJsonString(expense.currency);
     j["exchangeRate"] = expense.exchangeRate;
     j["location"] = WStringToString(expense.location);
 
@@ -792,22 +836,33 @@ json DatabaseManager::ExpenseToJson(const Expense& expense) {
     return j;
 }
 
-Expense DatabaseManager::JsonToExpense(const json& j) {
-    Expense expense;
-    if (j.contains("id")) expense.id = StringToWString(j["id"]);
-    if (j.contains("userId")) expense.userId = StringToWString(j["userId"]);
-    if (j.contains("category")) expense.category = StringToWString(j["category"]);
+Expense DatabaseManager::JsonToExpense(const json& j, std::pmr::memory_resource* resource) {
+    Expense expense(resource);
+    if (j.contains("id")) ReadJsonString(j["id"], expense.id);
+    if (j.contains("userId")) {
+        expense.userSymbol = InternJsonString(j["userId"]);
+        expense.userId = SymbolTable::Resolve(expense.userSymbol);
+    }
+    if (j.contains("category")) {
+        expense.categorySymbol = InternJsonString(j["category"]);
+        expense.category = SymbolTable::Resolve(expense.categorySymbol);
+    }
     if (j.contains("amount")) expense.amount = j["amount"];
-    if (j.contains("note")) expense.note = StringToWString(j["note"]);
-    if (j.contains("date")) expense.date = StringToWString(j["date"]);
-    if (j.contains("receiptPath")) expense.receiptPath = StringToWString(j["receiptPath"]);
-    if (j.contains("currency")) expense.currency = StringToCurrency(StringToWString(j["currency"]));
+    if (j.contains("note")) ReadJsonString(j["note"], expense.note);
+    if (j.contains("date")) ReadJsonString(j["date"], expense.date);
+    if (j.contains("receiptPath")) ReadJsonString(j["receiptPath"], expense.receiptPath);
+    if (j.contains("currency")) expense.currency = JsonToCurrency(j["currency"]);
     if (j.contains("exchangeRate")) expense.exchangeRate = j["exchangeRate"];
-    if (j.contains("location")) expense.location = StringToWString(j["location"]);
+    if (j.contains("location")) ReadJsonString(j["location"], expense.location);
 
     if (j.contains("tags") && j["tags"].is_array()) {
+        // Sized up front: the arena cannot reuse a buffer left behind by growth
+        expense.tagSymbols.reserve(j["tags"].size());
+        expense.tags.reserve(j["tags"].size());
         for (const auto& tagJson : j["tags"]) {
-            expense.tags.push_back(StringToWString(tagJson));
+            SymbolId tag = InternJsonString(tagJson);
+            expense.tagSymbols.push_back(tag);
+            expense.tags.emplace_back(SymbolTable::Resolve(tag));
         }
     }
 
@@ -823,7 +878,7 @@ json DatabaseManager::IncomeToJson(const Income& income) {
     j["amount"] = income.amount;
     j["note"] = WStringToString(income.note);
     j["date"] = WStringToString(income.date);
-    j["currency"] = WStringToString(CurrencyToString(income.currency));
+    j["currency"] = CurrencyToJsonString(income.currency);
     j["exchangeRate"] = income.exchangeRate;
     j["isTaxable"] = income.isTaxable;
 
@@ -836,21 +891,31 @@ json DatabaseManager::IncomeToJson(const Income& income) {
     return j;
 }
 
-Income DatabaseManager::JsonToIncome(const json& j) {
-    Income income;
-    if (j.contains("id")) income.id = StringToWString(j["id"]);
-    if (j.contains("userId")) income.userId = StringToWString(j["userId"]);
-    if (j.contains("source")) income.source = StringToWString(j["source"]);
+Income DatabaseManager::JsonToIncome(const json& j, std::pmr::memory_resource* resource) {
+    Income income(resource);
+    if (j.contains("id")) ReadJsonString(j["id"], income.id);
+    if (j.contains("userId")) {
+        income.userSymbol = InternJsonString(j["userId"]);
+        income.userId = SymbolTable::Resolve(income.userSymbol);
+    }
+    if (j.contains("source")) {
+        income.sourceSymbol = InternJsonString(j["source"]);
+        income.source = SymbolTable::Resolve(income.sourceSymbol);
+    }
     if (j.contains("amount")) income.amount = j["amount"];
-    if (j.contains("note")) income.note = StringToWString(j["note"]);
-    if (j.contains("date")) income.date = StringToWString(j["date"]);
-    if (j.contains("currency")) income.currency = StringToCurrency(StringToWString(j["currency"]));
+    if (j.contains("note")) ReadJsonString(j["note"], income.note);
+    if (j.contains("date")) ReadJsonString(j["date"], income.date);
+    if (j.contains("currency")) income.currency = JsonToCurrency(j["currency"]);
     if (j.contains("exchangeRate")) income.exchangeRate = j["exchangeRate"];
     if (j.contains("isTaxable")) income.isTaxable = j["isTaxable"];
 
     if (j.contains("tags") && j["tags"].is_array()) {
+        income.tagSymbols.reserve(j["tags"].size());
+        income.tags.reserve(j["tags"].size());
         for (const auto& tagJson : j["tags"]) {
-            income.tags.push_back(StringToWString(tagJson));
+            SymbolId tag = InternJsonString(tagJson);
+            income.tagSymbols.push_back(tag);
+            income.tags.emplace_back(SymbolTable::Resolve(tag));
         }
     }
 
@@ -875,10 +940,10 @@ bool DatabaseManager::FileExists(const std::wstring& path) {
     return (attributes != INVALID_FILE_ATTRIBUTES && !(attributes & FILE_ATTRIBUTE_DIRECTORY));
 }
 
-std::wstring DatabaseManager::EscapeCSVField(const std::wstring& field) {
-    if (field.find(L',') != std::wstring::npos ||
-        field.find(L'"') != std::wstring::npos ||
-        field.find(L'\n') != std::wstring::npos) {
+std::wstring DatabaseManager::EscapeCSVField(std::wstring_view field) {
+    if (field.find(L',') != std::wstring_view::npos ||
+        field.find(L'"') != std::wstring_view::npos ||
+        field.find(L'\n') != std::wstring_view::npos) {
 
         std::wstring escaped = L"\"";
         for (wchar_t c : field) {
@@ -892,7 +957,7 @@ std::wstring DatabaseManager::EscapeCSVField(const std::wstring& field) {
         escaped += L"\"";
         return escaped;
     }
-    return field;
+    return std::wstring(field);
 }
 
 std::vector<std::wstring> DatabaseManager::ParseCSVLine(const std::wstring& line) {
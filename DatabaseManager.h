@@ -43,10 +43,10 @@ private:
     static User JsonToUser(const json& j);
 
     static json ExpenseToJson(const Expense& expense);
-    static Expense JsonToExpense(const json& j);
+    static Expense JsonToExpense(const json& j, std::pmr::memory_resource* resource);
 
     static json IncomeToJson(const Income& income);
-    static Income JsonToIncome(const json& j);
+    static Income JsonToIncome(const json& j, std::pmr::memory_resource* resource);
 
     static json BudgetToJson(const Budget& budget);
     static Budget JsonToBudget(const json& j);
@@ -61,14 +61,12 @@ private:
     static Category JsonToCategory(const json& j);
 
     // Helper functions
-    static std::wstring WStringToString(const std::wstring& wstr);    // Correct: wstring -> string
-    static std::wstring StringToWString(const std::wstring& str);
     static bool CreateDirectoryIfNotExists(const std::wstring& path);
     static std::wstring GetTimestamp();
     static bool FileExists(const std::wstring& path);
 
     // CSV helpers
-    static std::wstring EscapeCSVField(const std::wstring& field);
+    static std::wstring EscapeCSVField(std::wstring_view field);
     static std::vector<std::wstring> ParseCSVLine(const std::wstring& line);
 
     // Auto-backup timer
@@ -90,7 +88,7 @@ private:
   
 
     // String/Enum conversion
-    static std::wstring TagsToString(const std::vector<std::wstring>& tags);
+    static std::wstring TagsToString(const RecordTags& tags);
     static std::vector<std::wstring> ParseTags(const std::wstring& tagString);
     
  
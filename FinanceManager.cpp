@@ -2,6 +2,7 @@
 #include "UserManager.h"
 #include "DatabaseManager.h"
 #include "Utils.h"
+#include "Ledger.h"
 #include <commctrl.h>
 #include <commdlg.h>
 #include <sstream>
@@ -13,8 +14,6 @@
 #include <functional>  // For std::function
 
 // Static member definitions - CRITICAL: Define static members
-std::vector<Expense> FinanceManager::expenses;
-
 std::vector<Category> FinanceManager::categories;
 
 // Static callback definitions
@@ -45,8 +44,8 @@ std::wstring FinanceManager::GenerateUniqueId() {
         L"-" + std::to_wstring(time(nullptr));
 }
 
-void FinanceManager::UpdateBudgetSpending(const std::wstring& userId,
-    const std::wstring& category,
+void FinanceManager::UpdateBudgetSpending(std::wstring_view userId,
+    std::wstring_view category,
     double amount) {
     // Find user's budget for this category
     for (auto& budget : budgets) {
@@ -85,8 +84,9 @@ bool FinanceManager::AddExpense(const Expense& expense) {
     if (newExpense.id.empty()) {
         newExpense.id = GenerateUniqueId();
     }
+    InternSymbols(newExpense);
 
-    expenses.push_back(newExpense);
+    ledger.AddExpense(expenses.Insert(newExpense).index);
 
     // Update budget spending
     UpdateBudgetSpending(expense.userId, expense.category, expense.amount);
@@ -110,8 +110,9 @@ bool FinanceManager::AddIncome(const Income& income) {
     if (newIncome.id.empty()) {
         newIncome.id = GenerateUniqueId();
     }
+    InternSymbols(newIncome);
 
-    incomes.push_back(newIncome);
+    ledger.AddIncome(incomes.Insert(newIncome).index);
 
     // Save data
     DatabaseManager::SaveAllData();
@@ -124,15 +125,17 @@ bool FinanceManager::AddIncome(const Income& income) {
 }
 
 bool FinanceManager::UpdateExpense(const std::wstring& id, const Expense& expense) {
-    auto it = std::find_if(expenses.begin(), expenses.end(),
-        [&id](const Expense& e) { return e.id == id; });
+    SlotHandle handle = expenses.Find(id);
 
-    if (it != expenses.end()) {
+    if (const Expense* existing = expenses.Get(handle)) {
         // Update budget spending (remove old, add new)
-        UpdateBudgetSpending(it->userId, it->category, -it->amount);
+        UpdateBudgetSpending(existing->userId, existing->category, -existing->amount);
 
-        *it = expense;
-        it->id = id; // Preserve ID
+        Expense updated = expense;
+        updated.id = id; // Preserve ID
+        InternSymbols(updated);
+        expenses.Replace(handle.index, std::move(updated));
+        ledger.UpdateExpense(handle.index);
 
         UpdateBudgetSpending(expense.userId, expense.category, expense.amount);
 
@@ -149,12 +152,14 @@ bool FinanceManager::UpdateExpense(const std::wstring& id, const Expense& expens
 }
 
 bool FinanceManager::UpdateIncome(const std::wstring& id, const Income& income) {
-    auto it = std::find_if(incomes.begin(), incomes.end(),
-        [&id](const Income& e) { return e.id == id; });
+    SlotHandle handle = incomes.Find(id);
 
-    if (it != incomes.end()) {
-        *it = income;
-        it->id = id; // Preserve ID
+    if (incomes.Contains(handle)) {
+        Income updated = income;
+        updated.id = id; // Preserve ID
+        InternSymbols(updated);
+        incomes.Replace(handle.index, std::move(updated));
+        ledger.UpdateIncome(handle.index);
 
         DatabaseManager::SaveAllData();
 
@@ -169,14 +174,14 @@ bool FinanceManager::UpdateIncome(const std::wstring& id, const Income& income)
 }
 
 bool FinanceManager::DeleteExpense(const std::wstring& id) {
-    auto it = std::find_if(expenses.begin(), expenses.end(),
-        [&id](const Expense& e) { return e.id == id; });
+    SlotHandle handle = expenses.Find(id);
 
-    if (it != expenses.end()) {
+    if (const Expense* existing = expenses.Get(handle)) {
         // Update budget spending
-        UpdateBudgetSpending(it->userId, it->category, -it->amount);
+        UpdateBudgetSpending(existing->userId, existing->category, -existing->amount);
 
-        expenses.erase(it);
+        ledger.RemoveExpense(handle.index);
+        expenses.Erase(handle);
 
         DatabaseManager::SaveAllData();
 
@@ -191,11 +196,11 @@ bool FinanceManager::DeleteExpense(const std::wstring& id) {
 }
 
 bool FinanceManager::DeleteIncome(const std::wstring& id) {
-    auto it = std::find_if(incomes.begin(), incomes.end(),
-        [&id](const Income& i) { return i.id == id; });
+    SlotHandle handle = incomes.Find(id);
 
-    if (it != incomes.end()) {
-        incomes.erase(it);
+    if (incomes.Contains(handle)) {
+        ledger.RemoveIncome(handle.index);
+        incomes.Erase(handle);
 
         DatabaseManager::SaveAllData();
 
@@ -211,41 +216,39 @@ bool FinanceManager::DeleteIncome(const std::wstring& id) {
 
 // Transaction retrieval
 Expense* FinanceManager::GetExpenseById(const std::wstring& id) {
-    auto it = std::find_if(expenses.begin(), expenses.end(),
-        [&id](const Expense& e) { return e.id == id; });
-
-    return (it != expenses.end()) ? &(*it) : nullptr;
+    return expenses.FindRecord(id);
 }
 
 Income* FinanceManager::GetIncomeById(const std::wstring& id) {
-    auto it = std::find_if(incomes.begin(), incomes.end(),
-        [&id](const Income& i) { return i.id == id; });
+    return incomes.FindRecord(id);
+}
 
-    return (it != incomes.end()) ? &(*it) : nullptr;
+SlotHandle FinanceManager::GetExpenseHandle(const std::wstring& id) {
+    return expenses.Find(id);
 }
 
-std::vector<Expense> FinanceManager::GetUserExpenses(const std::wstring& userId) {
-    std::vector<Expense> userExpenses;
-    for (const auto& expense : expenses) {
-        if (expense.userId == userId) {
-            userExpenses.push_back(expense);
-        }
-    }
-    return userExpenses;
+SlotHandle FinanceManager::GetIncomeHandle(const std::wstring& id) {
+    return incomes.Find(id);
 }
 
-std::vector<Income> FinanceManager::GetUserIncomes(const std::wstring& userId) {
-    std::vector<Income> userIncomes;
-    for (const auto& income : incomes) {
-        if (income.userId == userId) {
-            userIncomes.push_back(income);
-        }
-    }
-    return userIncomes;
+Expense* FinanceManager::GetExpense(SlotHandle handle) {
+    return expenses.Get(handle);
+}
+
+Income* FinanceManager::GetIncome(SlotHandle handle) {
+    return incomes.Get(handle);
+}
+
+RecordView<Expense> FinanceManager::GetUserExpenses(const std::wstring& userId) {
+    return UserDataFilter::GetUserExpenses(userId);
+}
+
+RecordView<Income> FinanceManager::GetUserIncomes(const std::wstring& userId) {
+    return UserDataFilter::GetUserIncomes(userId);
 }
 
 // Validation
-bool FinanceManager::ValidateTransactionData(const std::wstring& category, double amount, const std::wstring& date) {
+bool FinanceManager::ValidateTransactionData(std::wstring_view category, double amount, std::wstring_view date) {
     if (category.empty()) {
         MessageBox(NULL, L"Category cannot be empty.", L"Validation Error", MB_OK);
         return false;
@@ -284,8 +287,8 @@ bool FinanceManager::ValidateDate(const std::wstring& date) {
 }
 
 // Utility functions
-std::vector<std::wstring> FinanceManager::ParseTags(const std::wstring& tagString) {
-    std::vector<std::wstring> tags;
+RecordTags FinanceManager::ParseTags(const std::wstring& tagString) {
+    RecordTags tags;
     std::wstringstream ss(tagString);
     std::wstring tag;
 
@@ -295,14 +298,14 @@ std::vector<std::wstring> FinanceManager::ParseTags(const std::wstring& tagStrin
         tag.erase(tag.find_last_not_of(L" \t") + 1);
 
         if (!tag.empty()) {
-            tags.push_back(tag);
+            tags.emplace_back(tag);
         }
     }
 
     return tags;
 }
 
-std::wstring FinanceManager::TagsToString(const std::vector<std::wstring>& tags) {
+std::wstring FinanceManager::TagsToString(const RecordTags& tags) {
     std::wstring result;
     for (size_t i = 0; i < tags.size(); ++i) {
         if (i > 0) result += L", ";
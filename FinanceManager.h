@@ -51,8 +51,6 @@
 class FinanceManager {
 private:
     // Static data containers - shared across all instances
-    static std::vector<Expense> expenses;
-    
     static std::vector<Category> categories;
 
     static const std::vector<std::wstring> DEFAULT_INCOME_SOURCES;
@@ -62,7 +60,7 @@ public:
 
     // Utility functions - ADD THESE MISSING DECLARATIONS
     static std::wstring GenerateUniqueId();
-    static void UpdateBudgetSpending(const std::wstring& userId, const std::wstring& category, double amount);
+    static void UpdateBudgetSpending(std::wstring_view userId, std::wstring_view category, double amount);
 
     // Transaction dialogs
     static void ShowAddExpenseDialog(HWND parent);
@@ -80,22 +78,29 @@ public:
     // Transaction retrieval
     static Expense* GetExpenseById(const std::wstring& id);
     static Income* GetIncomeById(const std::wstring& id);
-    static std::vector<Expense> GetUserExpenses(const std::wstring& userId);
-    static std::vector<Income> GetUserIncomes(const std::wstring& userId);
+
+    // Handles survive later adds and deletes of other records, unlike the
+    // pointers above; resolving a handle to a deleted record returns nullptr
+    static SlotHandle GetExpenseHandle(const std::wstring& id);
+    static SlotHandle GetIncomeHandle(const std::wstring& id);
+    static Expense* GetExpense(SlotHandle handle);
+    static Income* GetIncome(SlotHandle handle);
+    static RecordView<Expense> GetUserExpenses(const std::wstring& userId);   // Valid until the next change
+    static RecordView<Income> GetUserIncomes(const std::wstring& userId);
 
     // Validation
-    static bool ValidateTransactionData(const std::wstring& category, double amount, const std::wstring& date);
+    static bool ValidateTransactionData(std::wstring_view category, double amount, std::wstring_view date);
     static bool ValidateAmount(const std::wstring& amountStr, double& amount);
     static bool ValidateDate(const std::wstring& date);
 
     // Utility functions
-    static std::vector<std::wstring> ParseTags(const std::wstring& tagString);
-    static std::wstring TagsToString(const std::vector<std::wstring>& tags);
+    static RecordTags ParseTags(const std::wstring& tagString);
+    static std::wstring TagsToString(const RecordTags& tags);
     static std::wstring SelectReceiptFile(HWND parent);
 
     // Data access functions - ADD THESE FOR EXTERNAL ACCESS
-    static std::vector<Expense>& GetExpenses() { return expenses; }
-    static std::vector<Income>& GetIncomes() { return incomes; }
+    static RecordStore<Expense>& GetExpenses() { return expenses; }
+    static RecordStore<Income>& GetIncomes() { return incomes; }
     static std::vector<Budget>& GetBudgets() { return budgets; }
     static std::vector<Category>& GetCategories() { return categories; }
 
@@ -124,12 +129,15 @@ private:
 class TransactionViewer {
 public:
     static void ShowTransactionListDialog(HWND parent);
+    // The list view must have LVS_OWNERDATA; rows are fetched as they are drawn
     static void RefreshTransactionList(HWND hListView, const FilterCriteria& criteria = FilterCriteria());
 
+    // Virtual list callbacks from WM_NOTIFY; false when not for the transaction list
+    static bool HandleListNotify(LPNMHDR header);
+
 private:
     static LRESULT CALLBACK TransactionListDialogProc(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam);
     static void SetupTransactionListView(HWND hListView);
-    static void PopulateTransactionList(HWND hListView, const std::vector<Expense>& expenses, const std::vector<Income>& incomes);
     static void HandleTransactionDoubleClick(HWND hListView);
     static void HandleTransactionDelete(HWND hListView);
 };
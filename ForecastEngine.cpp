@@ -0,0 +1,238 @@
+#include "ForecastEngine.h"
+#include "CurrencyManager.h"
+#include "RollupCube.h"
+#include "StatsKernels.h"
+#include "UserManager.h"
+#include "Utils.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// Closed months needed before forecasting
+const int FORECAST_MIN_MONTHS = 3;
+
+static int CalendarMonth(int monthIndex) {
+    return ((monthIndex % FORECAST_SEASON) + FORECAST_SEASON) % FORECAST_SEASON;
+}
+
+// HoltWintersModel
+void HoltWintersModel::Add(int monthIndex, double value) {
+    int calendarMonth = CalendarMonth(monthIndex);
+
+    if (observed > 0) {
+        double error = value - Forecast(monthIndex - lastMonth);
+        squaredErrors += error * error;
+        errorCount++;
+    }
+
+    if (observed == 0) {
+        level = value;
+        trend = 0.0;
+    }
+    else if (seasonSeeded) {
+        double offset = seasonal[calendarMonth];
+        double previousLevel = level;
+        level = ALPHA * (value - offset) + (1.0 - ALPHA) * (level + trend);
+        trend = BETA * (level - previousLevel) + (1.0 - BETA) * trend;
+        seasonal[calendarMonth] = GAMMA * (value - level) + (1.0 - GAMMA) * offset;
+    }
+    else {
+        double previousLevel = level;
+        level = ALPHA * value + (1.0 - ALPHA) * (level + trend);
+        trend = BETA * (level - previousLevel) + (1.0 - BETA) * trend;
+    }
+
+    observed++;
+    lastMonth = monthIndex;
+    magnitudeSum += std::abs(value);
+
+    if (!seasonSeeded) {
+        firstSeason.push_back(value);
+        if (firstSeason.size() == FORECAST_SEASON) SeedSeason();
+    }
+}
+
+// Each month's distance from the first season's mean is that calendar
+// month's offset. A trend fitted over a single season would mostly measure
+// where in the year it started, so the trend starts flat and is learned from
+// later seasons.
+void HoltWintersModel::SeedSeason() {
+    double mean = StatsKernels::Mean(firstSeason);
+
+    int firstMonth = lastMonth - (FORECAST_SEASON - 1);
+    for (int i = 0; i < FORECAST_SEASON; ++i) {
+        seasonal[CalendarMonth(firstMonth + i)] = firstSeason[i] - mean;
+    }
+    level = mean;
+    trend = 0.0;
+    seasonSeeded = true;
+
+    firstSeason.clear();
+    firstSeason.shrink_to_fit();
+}
+
+double HoltWintersModel::Forecast(int horizon) const {
+    double value = level + trend * horizon;
+    if (seasonSeeded) value += seasonal[CalendarMonth(lastMonth + horizon)];
+    return value;
+}
+
+double HoltWintersModel::ErrorDeviation() const {
+    return errorCount > 0 ? std::sqrt(squaredErrors / errorCount) : 0.0;
+}
+
+// Cached models of one user
+struct ForecastModels {
+    std::mutex lock;
+    bool fitted = false;
+    uint64_t historyRevision = 0;
+    uint64_t ratesVersion = 0;
+    CurrencyType currency = CurrencyType::USD;
+    int closedThrough = INT_MIN;   // Last month fed to the models
+
+    HoltWintersModel income;
+    HoltWintersModel expenses;
+    std::unordered_map<SymbolId, HoltWintersModel> categories;
+};
+
+static std::mutex cacheLock;
+static std::unordered_map<std::wstring, std::unique_ptr<ForecastModels>> cache;
+
+// Entries are never removed, so a reference stays valid after the cache lock is released
+static ForecastModels& ModelsFor(const std::wstring& userId) {
+    std::lock_guard<std::mutex> guard(cacheLock);
+    auto& entry = cache[userId];
+    if (!entry) entry = std::make_unique<ForecastModels>();
+    return *entry;
+}
+
+// Brings the models up to the last closed month. Months without rows count
+// as zero once the user has any history.
+static void Refresh(ForecastModels& models, SymbolId user, CurrencyType currency, int lastClosed) {
+    const auto& months = rollupCube.Months(user);
+    uint64_t revision = rollupCube.HistoryRevision(user);
+
+    if (!models.fitted || models.historyRevision != revision || models.currency != currency
+        || models.ratesVersion != CurrencyManager::RatesVersion()) {
+        models.income = HoltWintersModel();
+        models.expenses = HoltWintersModel();
+        models.categories.clear();
+        models.closedThrough = months.empty() ? lastClosed : std::min(lastClosed, months.begin()->first - 1);
+        models.fitted = true;
+        models.historyRevision = revision;
+        models.currency = currency;
+        models.ratesVersion = CurrencyManager::RatesVersion();
+    }
+
+    for (int month = models.closedThrough + 1; month <= lastClosed; ++month) {
+        double factors[CURRENCY_TYPE_COUNT];
+        CurrencyManager::FactorsOn(currency, MonthIndexToMidDay(month), factors);
+
+        // A category can have a cell per currency, so total before feeding
+        double incomeTotal = 0.0, expenseTotal = 0.0;
+        std::unordered_map<SymbolId, double> byCategory;
+        auto monthIt = months.find(month);
+        if (monthIt != months.end()) {
+            for (const auto& cell : monthIt->second) {
+                double converted = cell.sum * factors[cell.currency];
+                if (cell.income) {
+                    incomeTotal += converted;
+                }
+                else {
+                    expenseTotal += converted;
+                    byCategory[cell.category] += converted;
+                }
+            }
+        }
+
+        models.income.Add(month, incomeTotal);
+        models.expenses.Add(month, expenseTotal);
+        for (const auto& [category, total] : byCategory) models.categories[category].Add(month, total);
+        for (auto& [category, model] : models.categories) {
+            // Categories start with their first month of spending
+            if (model.LastMonth() != month) model.Add(month, 0.0);
+        }
+    }
+    models.closedThrough = std::max(models.closedThrough, lastClosed);
+}
+
+// Reporting currency and symbol of a user; false if the user has no rows
+static bool ResolveUser(const std::wstring& userId, SymbolId& user, CurrencyType& currency) {
+    user = SymbolTable::Find(userId);
+    if (user == INVALID_SYMBOL) return false;
+
+    User* record = UserManager::GetUserByUsername(userId);
+    currency = record ? record->defaultCurrency : CurrencyType::USD;
+    return true;
+}
+
+std::vector<FinancialForecast> ForecastEngine::Forecast(const std::wstring& userId, int monthsAhead) {
+    SymbolId user;
+    CurrencyType currency;
+    if (!ResolveUser(userId, user, currency)) return {};
+
+    return Forecast(userId, user, currency, monthsAhead);
+}
+
+std::vector<FinancialForecast> ForecastEngine::Forecast(const User& record, int monthsAhead) {
+    SymbolId user = SymbolTable::Find(record.username);
+    if (user == INVALID_SYMBOL) return {};
+
+    return Forecast(record.username, user, record.defaultCurrency, monthsAhead);
+}
+
+std::vector<FinancialForecast> ForecastEngine::Forecast(const std::wstring& userId, SymbolId user, CurrencyType currency, int monthsAhead) {
+    std::vector<FinancialForecast> forecasts;
+
+    int currentMonth = CurrentMonthIndex();
+    ForecastModels& models = ModelsFor(userId);
+    std::lock_guard<std::mutex> guard(models.lock);
+    Refresh(models, user, currency, currentMonth - 1);
+
+    if (models.expenses.Observed() < FORECAST_MIN_MONTHS) return forecasts;
+
+    // Lower one-step error relative to the typical month means higher confidence
+    auto relativeError = [](const HoltWintersModel& model) {
+        double magnitude = model.MeanMagnitude();
+        return magnitude > 0 ? model.ErrorDeviation() / magnitude : 1.0;
+    };
+    double confidence = 1.0 - (relativeError(models.income) + relativeError(models.expenses)) / 2.0;
+    confidence = std::min(0.95, std::max(0.1, confidence));
+
+    for (int i = 1; i <= monthsAhead; ++i) {
+        // Horizon 1 is the current month, still open
+        int horizon = i + 1;
+
+        FinancialForecast forecast;
+        forecast.period = MonthIndexToKey(currentMonth + i);
+        forecast.predictedIncome = std::max(0.0, models.income.Forecast(horizon));
+        forecast.predictedExpenses = std::max(0.0, models.expenses.Forecast(horizon));
+        forecast.predictedBalance = forecast.predictedIncome - forecast.predictedExpenses;
+        forecast.confidence = confidence;
+        forecasts.push_back(forecast);
+    }
+
+    return forecasts;
+}
+
+std::map<std::wstring, double> ForecastEngine::ForecastCategories(const std::wstring& userId, int monthsAhead) {
+    std::map<std::wstring, double> result;
+
+    SymbolId user;
+    CurrencyType currency;
+    if (!ResolveUser(userId, user, currency)) return result;
+
+    ForecastModels& models = ModelsFor(userId);
+    std::lock_guard<std::mutex> guard(models.lock);
+    Refresh(models, user, currency, CurrentMonthIndex() - 1);
+
+    for (const auto& [category, model] : models.categories) {
+        if (model.Observed() < FORECAST_MIN_MONTHS) continue;
+        result[std::wstring(SymbolTable::Resolve(category))] = std::max(0.0, model.Forecast(monthsAhead + 1));
+    }
+
+    return result;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "Analytics.h"
+#include <map>
+#include <string>
+#include <vector>
+
+// Months in a forecasting season
+const int FORECAST_SEASON = 12;
+
+// Additive Holt-Winters model of a monthly series: a level, a trend and one
+// offset per calendar month, each exponentially smoothed. Fed one month at a
+// time in order, O(1) per month. Until a full season has been seen it is a
+// plain trend model; that first season then seeds the seasonal offsets.
+class HoltWintersModel {
+public:
+    void Add(int monthIndex, double value);
+
+    // Expected value horizon (>= 1) months after the last month added
+    double Forecast(int horizon) const;
+
+    int Observed() const { return observed; }
+    int LastMonth() const { return lastMonth; }
+
+    // Root mean square of the one-step-ahead errors made while fitting, and
+    // the mean absolute value, for judging how predictable the series is
+    double ErrorDeviation() const;
+    double MeanMagnitude() const { return observed > 0 ? magnitudeSum / observed : 0.0; }
+
+private:
+    static constexpr double ALPHA = 0.3;   // Level
+    static constexpr double BETA = 0.1;    // Trend
+    static constexpr double GAMMA = 0.2;   // Seasonal offsets
+
+    void SeedSeason();
+
+    double level = 0.0;
+    double trend = 0.0;
+    double seasonal[FORECAST_SEASON] = {};   // By calendar month
+    bool seasonSeeded = false;
+    std::vector<double> firstSeason;         // Held until it seeds the offsets
+
+    int observed = 0;
+    int lastMonth = 0;
+    double squaredErrors = 0.0;
+    int errorCount = 0;
+    double magnitudeSum = 0.0;
+};
+
+// Income, expense and per-category forecasts from Holt-Winters models of each
+// user's closed months (every month before the current one), read from the
+// rollup cube. Fitted models are cached per user. When a month closes, only
+// that month is fed to them. They are refit from scratch only if closed
+// history changes, or the user's currency or the exchange rates do. Any
+// horizon is then read from the cached models. Safe to call from several
+// threads at once.
+class ForecastEngine {
+public:
+    // The monthsAhead months after the current one; empty until the user has
+    // three closed months
+    static std::vector<FinancialForecast> Forecast(const std::wstring& userId, int monthsAhead);
+    // For a user record already at hand, without looking it up by name
+    static std::vector<FinancialForecast> Forecast(const User& user, int monthsAhead);
+
+    // Expected spending by category, monthsAhead months after the current one
+    static std::map<std::wstring, double> ForecastCategories(const std::wstring& userId, int monthsAhead = 1);
+
+private:
+    static std::vector<FinancialForecast> Forecast(const std::wstring& userId, SymbolId user, CurrencyType currency, int monthsAhead);
+};
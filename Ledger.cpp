@@ -0,0 +1,384 @@
+#include "Ledger.h"
+#include "LedgerTimeline.h"
+#include "UserPostings.h"
+#include "CategoryTagIndex.h"
+#include "TextIndex.h"
+#include "TermIndex.h"
+#include "AmountIndex.h"
+#include "SortIndex.h"
+#include "RollupCube.h"
+#include "AnomalyIndex.h"
+#include "QuantileIndex.h"
+#include "Utils.h"
+#include <algorithm>
+
+TransactionLedger ledger;
+
+DayRange ToDayRange(const DateRange& range) {
+    DayRange days;
+    if (!range.startDate.empty()) days.first = DateToDayNumber(range.startDate);
+    if (!range.endDate.empty()) days.last = DateToDayNumber(range.endDate);
+    return days;
+}
+
+// LedgerRow
+bool LedgerRow::IsIncome() const {
+    return (owner->Flags()[row] & LEDGER_INCOME) != 0;
+}
+
+int32_t LedgerRow::Day() const {
+    return owner->Days()[row];
+}
+
+double LedgerRow::Amount() const {
+    return owner->Amounts()[row];
+}
+
+SymbolId LedgerRow::User() const {
+    return owner->Users()[row];
+}
+
+SymbolId LedgerRow::Category() const {
+    return owner->Categories()[row];
+}
+
+CurrencyType LedgerRow::Currency() const {
+    return static_cast<CurrencyType>(owner->Currencies()[row]);
+}
+
+std::span<const SymbolId> LedgerRow::Tags() const {
+    return owner->Tags(row);
+}
+
+const Expense& LedgerRow::GetExpense() const {
+    return expenses.At(owner->Records()[row]);
+}
+
+const Income& LedgerRow::GetIncome() const {
+    return incomes.At(owner->Records()[row]);
+}
+
+void AttachLedgerIndexes() {
+    ledger.Attach(&ledgerTimeline);
+    ledger.Attach(&userPostings);
+    ledger.Attach(&userTimeline);
+    ledger.Attach(&categoryTagIndex);
+    ledger.Attach(&textIndex);
+    ledger.Attach(&termIndex);
+    ledger.Attach(&amountIndex);
+    ledger.Attach(&sortIndex);
+    ledger.Attach(&rollupCube);
+    ledger.Attach(&anomalyIndex);
+    ledger.Attach(&quantileIndex);
+}
+
+// TransactionLedger
+void TransactionLedger::Attach(LedgerIndex* index) {
+    if (std::find(indexes.begin(), indexes.end(), index) != indexes.end()) return;
+
+    indexes.push_back(index);
+    index->OnRebuilt();
+}
+
+void TransactionLedger::Detach(LedgerIndex* index) {
+    indexes.erase(std::remove(indexes.begin(), indexes.end(), index), indexes.end());
+}
+
+void TransactionLedger::Rebuild() {
+    Clear();
+    rebuilding = true;
+
+    // Exact-size reservations keep a rebuild to one allocation per column
+    size_t rows = expenses.size() + incomes.size();
+    size_t tagCount = 0;
+    for (const auto& expense : expenses) tagCount += expense.tagSymbols.size();
+    for (const auto& income : incomes) tagCount += income.tagSymbols.size();
+
+    dayColumn.reserve(rows);
+    amountColumn.reserve(rows);
+    userColumn.reserve(rows);
+    categoryColumn.reserve(rows);
+    currencyColumn.reserve(rows);
+    flagColumn.reserve(rows);
+    recordColumn.reserve(rows);
+    seqColumn.reserve(rows);
+    tagOffsets.reserve(rows);
+    tagCounts.reserve(rows);
+    tagPool.reserve(tagCount);
+    liveRows.reserve(BitmapWords(rows));
+    expenseRows.reserve(expenses.SlotCount());
+    incomeRows.reserve(incomes.SlotCount());
+
+    for (auto it = expenses.begin(); it != expenses.end(); ++it) {
+        AddExpense(it.Slot());
+    }
+    for (auto it = incomes.begin(); it != incomes.end(); ++it) {
+        AddIncome(it.Slot());
+    }
+
+    rebuilding = false;
+    for (auto* index : indexes) index->OnRebuilt();
+}
+
+void TransactionLedger::Clear() {
+    dayColumn.clear();
+    amountColumn.clear();
+    userColumn.clear();
+    categoryColumn.clear();
+    currencyColumn.clear();
+    flagColumn.clear();
+    recordColumn.clear();
+    seqColumn.clear();
+    tagOffsets.clear();
+    tagCounts.clear();
+    tagPool.clear();
+    liveRows.clear();
+    expenseRows.clear();
+    incomeRows.clear();
+    deadTags = 0;
+    deadRows = 0;
+    firstDead = SIZE_MAX;
+    nextSeq = 0;
+    ++version;
+
+    for (auto* index : indexes) index->OnCleared();
+}
+
+void TransactionLedger::AddExpense(uint32_t slot) {
+    size_t row = Size();
+    AppendRow(0, slot);
+    WriteRow(row, expenses.At(slot));
+
+    if (expenseRows.size() <= slot) expenseRows.resize(slot + 1, NO_ROW);
+    expenseRows[slot] = static_cast<uint32_t>(row);
+
+    if (!rebuilding) {
+        for (auto* index : indexes) index->OnRowAdded(row);
+    }
+}
+
+void TransactionLedger::AddIncome(uint32_t slot) {
+    size_t row = Size();
+    AppendRow(LEDGER_INCOME, slot);
+    WriteRow(row, incomes.At(slot));
+
+    if (incomeRows.size() <= slot) incomeRows.resize(slot + 1, NO_ROW);
+    incomeRows[slot] = static_cast<uint32_t>(row);
+
+    if (!rebuilding) {
+        for (auto* index : indexes) index->OnRowAdded(row);
+    }
+}
+
+void TransactionLedger::UpdateExpense(uint32_t slot) {
+    if (slot >= expenseRows.size() || expenseRows[slot] == NO_ROW) return;
+
+    // Indexes see an update as a remove followed by an add of the same row
+    size_t row = expenseRows[slot];
+    for (auto* index : indexes) index->OnRowRemoving(row);
+    WriteRow(row, expenses.At(slot));
+    for (auto* index : indexes) index->OnRowAdded(row);
+}
+
+void TransactionLedger::UpdateIncome(uint32_t slot) {
+    if (slot >= incomeRows.size() || incomeRows[slot] == NO_ROW) return;
+
+    size_t row = incomeRows[slot];
+    for (auto* index : indexes) index->OnRowRemoving(row);
+    WriteRow(row, incomes.At(slot));
+    for (auto* index : indexes) index->OnRowAdded(row);
+}
+
+void TransactionLedger::RemoveExpense(uint32_t slot) {
+    RemoveRow(expenseRows, slot);
+}
+
+void TransactionLedger::RemoveIncome(uint32_t slot) {
+    RemoveRow(incomeRows, slot);
+}
+
+void TransactionLedger::RemoveExpenses(std::span<const uint32_t> slots) {
+    RemoveRows(expenseRows, slots);
+}
+
+void TransactionLedger::RemoveIncomes(std::span<const uint32_t> slots) {
+    RemoveRows(incomeRows, slots);
+}
+
+size_t TransactionLedger::Compact(size_t maxMoves) {
+    size_t moves = 0;
+    while (deadRows > 0 && moves < maxMoves) {
+        size_t last = Size() - 1;
+        if (!IsLive(last)) {
+            PopRow();
+            deadRows--;
+            continue;
+        }
+
+        // Fill the lowest hole so firstDead only moves forward
+        size_t hole = NextClearBit(liveRows, firstDead, last);
+        for (auto* index : indexes) index->OnRowMoved(last, hole);
+        MoveRow(last, hole);
+        PopRow();
+        deadRows--;
+        firstDead = hole + 1;
+        moves++;
+    }
+
+    if (deadRows == 0) firstDead = SIZE_MAX;
+    return deadRows;
+}
+
+std::span<const SymbolId> TransactionLedger::Tags(size_t row) const {
+    return std::span<const SymbolId>(tagPool.data() + tagOffsets[row], tagCounts[row]);
+}
+
+void TransactionLedger::WriteRow(size_t row, const Expense& expense) {
+    dayColumn[row] = DateToDayNumber(expense.date);
+    amountColumn[row] = expense.amount;
+    userColumn[row] = expense.userSymbol;
+    categoryColumn[row] = expense.categorySymbol;
+    currencyColumn[row] = static_cast<uint8_t>(expense.currency);
+    flagColumn[row] = 0;
+    WriteTags(row, expense.tagSymbols);
+    ++version;
+}
+
+void TransactionLedger::WriteRow(size_t row, const Income& income) {
+    dayColumn[row] = DateToDayNumber(income.date);
+    amountColumn[row] = income.amount;
+    userColumn[row] = income.userSymbol;
+    categoryColumn[row] = income.sourceSymbol;
+    currencyColumn[row] = static_cast<uint8_t>(income.currency);
+    flagColumn[row] = LEDGER_INCOME | (income.isTaxable ? LEDGER_TAXABLE : 0);
+    WriteTags(row, income.tagSymbols);
+    ++version;
+}
+
+void TransactionLedger::WriteTags(size_t row, std::span<const SymbolId> tags) {
+    uint32_t count = static_cast<uint32_t>(tags.size());
+
+    // Reuse the row's slice when the new tags fit, otherwise append a new one
+    if (count > tagCounts[row]) {
+        deadTags += tagCounts[row];
+        tagOffsets[row] = static_cast<uint32_t>(tagPool.size());
+        tagPool.insert(tagPool.end(), tags.begin(), tags.end());
+    }
+    else {
+        deadTags += tagCounts[row] - count;
+        std::copy(tags.begin(), tags.end(), tagPool.begin() + tagOffsets[row]);
+    }
+    tagCounts[row] = count;
+}
+
+void TransactionLedger::AppendRow(uint8_t flags, uint32_t slot) {
+    dayColumn.push_back(INVALID_DAY);
+    amountColumn.push_back(0.0);
+    userColumn.push_back(EMPTY_SYMBOL);
+    categoryColumn.push_back(EMPTY_SYMBOL);
+    currencyColumn.push_back(0);
+    flagColumn.push_back(flags);
+    recordColumn.push_back(slot);
+    seqColumn.push_back(nextSeq++);
+    tagOffsets.push_back(static_cast<uint32_t>(tagPool.size()));
+    tagCounts.push_back(0);
+
+    if (liveRows.size() < BitmapWords(Size())) liveRows.push_back(0);
+    SetBit(liveRows, Size() - 1);
+}
+
+void TransactionLedger::RemoveRow(std::vector<uint32_t>& rowsOf, uint32_t slot) {
+    if (slot >= rowsOf.size() || rowsOf[slot] == NO_ROW) return;
+
+    for (auto* index : indexes) index->OnRowRemoving(rowsOf[slot]);
+    KillRow(rowsOf, slot);
+
+    if (deadTags > 64 && deadTags * 2 > tagPool.size()) {
+        CompactTags();
+    }
+}
+
+void TransactionLedger::RemoveRows(std::vector<uint32_t>& rowsOf, std::span<const uint32_t> slots) {
+    std::vector<uint32_t> killed;
+    killed.reserve(slots.size());
+    for (uint32_t slot : slots) {
+        if (slot >= rowsOf.size() || rowsOf[slot] == NO_ROW) continue;
+
+        killed.push_back(rowsOf[slot]);
+        KillRow(rowsOf, slot);
+    }
+    if (killed.empty()) return;
+
+    for (auto* index : indexes) index->OnRowsRemoved(killed);
+
+    if (deadTags > 64 && deadTags * 2 > tagPool.size()) {
+        CompactTags();
+    }
+}
+
+// Tombstones the slot's row, which must exist. Its columns stay readable until Compact() reuses
+// it, its tags until the next CompactTags().
+void TransactionLedger::KillRow(std::vector<uint32_t>& rowsOf, uint32_t slot) {
+    size_t row = rowsOf[slot];
+    rowsOf[slot] = NO_ROW;
+    ClearBit(liveRows, row);
+    deadTags += tagCounts[row];
+    deadRows++;
+    ++version;
+    firstDead = std::min(firstDead, row);
+}
+
+void TransactionLedger::MoveRow(size_t from, size_t to) {
+    dayColumn[to] = dayColumn[from];
+    amountColumn[to] = amountColumn[from];
+    userColumn[to] = userColumn[from];
+    categoryColumn[to] = categoryColumn[from];
+    currencyColumn[to] = currencyColumn[from];
+    flagColumn[to] = flagColumn[from];
+    recordColumn[to] = recordColumn[from];
+    seqColumn[to] = seqColumn[from];
+    tagOffsets[to] = tagOffsets[from];
+    tagCounts[to] = tagCounts[from];
+    SetBit(liveRows, to);
+
+    auto& rowsOf = (flagColumn[to] & LEDGER_INCOME) ? incomeRows : expenseRows;
+    rowsOf[recordColumn[to]] = static_cast<uint32_t>(to);
+}
+
+void TransactionLedger::PopRow() {
+    ClearBit(liveRows, Size() - 1);
+
+    dayColumn.pop_back();
+    amountColumn.pop_back();
+    userColumn.pop_back();
+    categoryColumn.pop_back();
+    currencyColumn.pop_back();
+    flagColumn.pop_back();
+    recordColumn.pop_back();
+    seqColumn.pop_back();
+    tagOffsets.pop_back();
+    tagCounts.pop_back();
+
+    if (liveRows.size() > BitmapWords(Size())) liveRows.pop_back();
+}
+
+void TransactionLedger::CompactTags() {
+    std::vector<SymbolId> pool;
+    pool.reserve(tagPool.size() - deadTags);
+
+    for (size_t row = 0; row < Size(); ++row) {
+        // Dead rows were counted in deadTags when they were removed
+        if (!IsLive(row)) {
+            tagCounts[row] = 0;
+            continue;
+        }
+
+        uint32_t offset = static_cast<uint32_t>(pool.size());
+        pool.insert(pool.end(), tagPool.begin() + tagOffsets[row],
+            tagPool.begin() + tagOffsets[row] + tagCounts[row]);
+        tagOffsets[row] = offset;
+    }
+
+    tagPool.swap(pool);
+    deadTags = 0;
+}
@@ -0,0 +1,182 @@
+#pragma once
+#include "DataStructures.h"
+#include "Bitmap.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Rows moved per Compact() call from the idle timer
+const size_t LEDGER_COMPACT_BATCH = 4096;
+
+// Row flags
+const uint8_t LEDGER_INCOME = 0x01;     // Row mirrors an Income, otherwise an Expense
+const uint8_t LEDGER_TAXABLE = 0x02;    // Income::isTaxable
+
+// Inclusive bounds in day numbers (see DateToDayNumber). The default range matches every row.
+struct DayRange {
+    int32_t first;
+    int32_t last;
+
+    DayRange() : first(INT32_MIN), last(INT32_MAX) {}
+    DayRange(int32_t f, int32_t l) : first(f), last(l) {}
+
+    bool Contains(int32_t day) const { return day >= first && day <= last; }
+};
+
+// Converts a DateRange; empty dates leave that side open
+DayRange ToDayRange(const DateRange& range);
+
+class TransactionLedger;
+
+// Secondary structure kept in step with the ledger through these callbacks.
+// Removal only tombstones a row; row numbers change when Compact() moves the
+// last live row into a dead one.
+class LedgerIndex {
+public:
+    virtual ~LedgerIndex() = default;
+
+    virtual void OnRebuilt() = 0;                       // Bulk load finished; build from scratch
+    virtual void OnCleared() = 0;
+    virtual void OnRowAdded(size_t row) = 0;
+    virtual void OnRowRemoving(size_t row) = 0;         // Row is still readable
+    virtual void OnRowsRemoved(std::span<const uint32_t> rows) = 0;  // Bulk removal; rows are dead but readable
+    virtual void OnRowMoved(size_t from, size_t to) = 0; // Sent before 'from' is copied into 'to'
+};
+
+// Row view for callers that need the whole record (notes, receipts, ids...)
+class LedgerRow {
+public:
+    LedgerRow(const TransactionLedger& source, size_t row) : owner(&source), row(row) {}
+
+    bool IsIncome() const;
+    int32_t Day() const;
+    double Amount() const;
+    SymbolId User() const;
+    SymbolId Category() const;      // Source for incomes
+    CurrencyType Currency() const;
+    std::span<const SymbolId> Tags() const;
+
+    // Only valid for the matching row kind
+    const Expense& GetExpense() const;
+    const Income& GetIncome() const;
+
+private:
+    const TransactionLedger* owner;
+    size_t row;
+};
+
+// Column-oriented mirror of the global expenses and incomes stores.
+// Each column is a contiguous array, so a scan only touches the fields it reads;
+// tags live in a shared pool and everything else stays in the record.
+// The stores remain the owners of the data: every code path that changes them
+// must either report the change here or call Rebuild().
+// Removing a row tombstones it in O(1). Scans skip dead rows through the live
+// bitmap (ForEachRow) and Compact() reclaims them later, a bounded number of
+// moves at a time.
+class TransactionLedger {
+public:
+    void Rebuild();
+    void Clear();
+
+    // slot is the record's slot in the expenses / incomes store.
+    // Add after inserting, Update after editing in place, Remove before erasing.
+    void AddExpense(uint32_t slot);
+    void AddIncome(uint32_t slot);
+    void UpdateExpense(uint32_t slot);
+    void UpdateIncome(uint32_t slot);
+    void RemoveExpense(uint32_t slot);
+    void RemoveIncome(uint32_t slot);
+
+    // Bulk removal: indexes get one OnRowsRemoved() instead of a call per row
+    void RemoveExpenses(std::span<const uint32_t> slots);
+    void RemoveIncomes(std::span<const uint32_t> slots);
+
+    // Fills dead rows with live ones from the end, at most maxMoves of them.
+    // Returns the number of dead rows left.
+    size_t Compact(size_t maxMoves = SIZE_MAX);
+    bool NeedsCompaction() const { return deadRows > 64 && deadRows * 4 > Size(); }
+
+    // Rows including tombstones; scans must skip rows that are not IsLive()
+    size_t Size() const { return dayColumn.size(); }
+    size_t LiveCount() const { return Size() - deadRows; }
+    bool IsLive(size_t row) const { return TestBit(liveRows, row); }
+
+    // Calls fn(row) for every live row in row order
+    template <typename Fn>
+    void ForEachRow(Fn fn) const {
+        for (size_t row = NextSetBit(liveRows, 0, Size()); row < Size();
+            row = NextSetBit(liveRows, row + 1, Size())) {
+            fn(row);
+        }
+    }
+
+    LedgerRow Row(size_t row) const { return LedgerRow(*this, row); }
+
+    // Changes whenever a row is added, edited or removed, or the ledger is
+    // cleared; compaction leaves it alone. Caches of derived figures compare
+    // it to know they are stale.
+    uint64_t Version() const { return version; }
+
+    // Registers an index and builds it from the current rows
+    void Attach(LedgerIndex* index);
+    void Detach(LedgerIndex* index);
+
+    // Columns, indexed by row. Row order is unspecified.
+    std::span<const int32_t> Days() const { return dayColumn; }
+    std::span<const double> Amounts() const { return amountColumn; }
+    std::span<const SymbolId> Users() const { return userColumn; }
+    std::span<const SymbolId> Categories() const { return categoryColumn; }
+    std::span<const uint8_t> Currencies() const { return currencyColumn; }
+    std::span<const uint8_t> Flags() const { return flagColumn; }
+    std::span<const uint32_t> Records() const { return recordColumn; }     // Store slot
+    std::span<const uint32_t> Sequences() const { return seqColumn; }   // Insertion order, unique
+    std::span<const SymbolId> Tags(size_t row) const;
+
+private:
+    void WriteRow(size_t row, const Expense& expense);
+    void WriteRow(size_t row, const Income& income);
+    void WriteTags(size_t row, std::span<const SymbolId> tags);
+    void AppendRow(uint8_t flags, uint32_t slot);
+    void RemoveRow(std::vector<uint32_t>& rowsOf, uint32_t slot);
+    void RemoveRows(std::vector<uint32_t>& rowsOf, std::span<const uint32_t> slots);
+    void KillRow(std::vector<uint32_t>& rowsOf, uint32_t slot);
+    void MoveRow(size_t from, size_t to);
+    void PopRow();
+    void CompactTags();
+
+    std::vector<int32_t> dayColumn;
+    std::vector<double> amountColumn;
+    std::vector<SymbolId> userColumn;
+    std::vector<SymbolId> categoryColumn;
+    std::vector<uint8_t> currencyColumn;
+    std::vector<uint8_t> flagColumn;
+    std::vector<uint32_t> recordColumn;
+    std::vector<uint32_t> seqColumn;
+    uint32_t nextSeq = 0;
+
+    // Out-of-line tags: each row owns tagCounts[row] ids starting at tagOffsets[row]
+    std::vector<uint32_t> tagOffsets;
+    std::vector<uint32_t> tagCounts;
+    std::vector<SymbolId> tagPool;
+    size_t deadTags = 0;
+
+    // Set for live rows; dead rows keep their column values until compacted
+    std::vector<uint64_t> liveRows;
+    size_t deadRows = 0;
+    size_t firstDead = SIZE_MAX;   // No dead row below this one
+
+    // Store slot -> row, NO_ROW for free slots and dead rows
+    static constexpr uint32_t NO_ROW = UINT32_MAX;
+    std::vector<uint32_t> expenseRows;
+    std::vector<uint32_t> incomeRows;
+
+    std::vector<LedgerIndex*> indexes;
+    uint64_t version = 0;      // Never reset, so a cleared ledger does not repeat an old version
+    bool rebuilding = false;   // Per-row notifications are skipped during Rebuild()
+};
+
+extern TransactionLedger ledger;
+
+// Attaches the application's ledger indexes. Called once at startup, before
+// the first load.
+void AttachLedgerIndexes();
@@ -0,0 +1,138 @@
+#include "LedgerTimeline.h"
+#include <algorithm>
+
+LedgerTimeline ledgerTimeline;
+UserTimeline userTimeline;
+
+static bool EntryBefore(const TimelineEntry& a, const TimelineEntry& b) {
+    return a.day != b.day ? a.day < b.day : a.seq < b.seq;
+}
+
+static TimelineEntry MakeEntry(size_t row) {
+    return { ledger.Days()[row], ledger.Sequences()[row], static_cast<uint32_t>(row) };
+}
+
+// DateOrderedRows
+std::span<const TimelineEntry> DateOrderedRows::Range(const DayRange& days) const {
+    auto first = std::lower_bound(entries.begin(), entries.end(), days.first,
+        [](const TimelineEntry& entry, int32_t day) { return entry.day < day; });
+    auto last = std::upper_bound(first, entries.end(), days.last,
+        [](int32_t day, const TimelineEntry& entry) { return day < entry.day; });
+    return std::span<const TimelineEntry>(entries.data() + (first - entries.begin()), last - first);
+}
+
+void DateOrderedRows::Append(size_t row) {
+    entries.push_back(MakeEntry(row));
+}
+
+void DateOrderedRows::Sort() {
+    std::sort(entries.begin(), entries.end(), EntryBefore);
+}
+
+void DateOrderedRows::Insert(size_t row) {
+    TimelineEntry entry = MakeEntry(row);
+
+    // New transactions are usually the latest ones, so this is mostly an append
+    if (entries.empty() || EntryBefore(entries.back(), entry)) {
+        entries.push_back(entry);
+        return;
+    }
+    entries.insert(std::upper_bound(entries.begin(), entries.end(), entry, EntryBefore), entry);
+}
+
+void DateOrderedRows::Erase(size_t row) {
+    auto it = Find(row);
+    if (it != entries.end()) {
+        entries.erase(it);
+    }
+}
+
+void DateOrderedRows::Renumber(size_t from, size_t to) {
+    auto it = Find(from);
+    if (it != entries.end()) {
+        it->row = static_cast<uint32_t>(to);
+    }
+}
+
+void DateOrderedRows::EraseDead() {
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+        [](const TimelineEntry& entry) { return !ledger.IsLive(entry.row); }), entries.end());
+}
+
+std::vector<TimelineEntry>::iterator DateOrderedRows::Find(size_t row) {
+    TimelineEntry key = MakeEntry(row);
+    auto it = std::lower_bound(entries.begin(), entries.end(), key, EntryBefore);
+    return (it != entries.end() && it->seq == key.seq) ? it : entries.end();
+}
+
+// LedgerTimeline
+void LedgerTimeline::OnRebuilt() {
+    rows.Clear();
+    ledger.ForEachRow([this](size_t row) { rows.Append(row); });
+    rows.Sort();
+}
+
+void LedgerTimeline::OnCleared() {
+    rows.Clear();
+}
+
+void LedgerTimeline::OnRowAdded(size_t row) {
+    rows.Insert(row);
+}
+
+void LedgerTimeline::OnRowRemoving(size_t row) {
+    rows.Erase(row);
+}
+
+void LedgerTimeline::OnRowsRemoved(std::span<const uint32_t>) {
+    // One pass for the whole batch instead of an erase per row
+    rows.EraseDead();
+}
+
+void LedgerTimeline::OnRowMoved(size_t from, size_t to) {
+    rows.Renumber(from, to);
+}
+
+// UserTimeline
+std::span<const TimelineEntry> UserTimeline::Range(SymbolId user, const DayRange& days) const {
+    auto it = byUser.find(user);
+    if (it == byUser.end()) return {};
+    return it->second.Range(days);
+}
+
+void UserTimeline::OnRebuilt() {
+    byUser.clear();
+    ledger.ForEachRow([this](size_t row) { byUser[ledger.Users()[row]].Append(row); });
+    for (auto& pair : byUser) pair.second.Sort();
+}
+
+void UserTimeline::OnCleared() {
+    byUser.clear();
+}
+
+void UserTimeline::OnRowAdded(size_t row) {
+    byUser[ledger.Users()[row]].Insert(row);
+}
+
+void UserTimeline::OnRowRemoving(size_t row) {
+    auto it = byUser.find(ledger.Users()[row]);
+    if (it != byUser.end()) it->second.Erase(row);
+}
+
+void UserTimeline::OnRowsRemoved(std::span<const uint32_t> rows) {
+    // Only the users that lost rows need a pass
+    std::vector<SymbolId> touched;
+    for (uint32_t row : rows) {
+        SymbolId user = ledger.Users()[row];
+        if (std::find(touched.begin(), touched.end(), user) != touched.end()) continue;
+
+        touched.push_back(user);
+        auto it = byUser.find(user);
+        if (it != byUser.end()) it->second.EraseDead();
+    }
+}
+
+void UserTimeline::OnRowMoved(size_t from, size_t to) {
+    auto it = byUser.find(ledger.Users()[from]);
+    if (it != byUser.end()) it->second.Renumber(from, to);
+}
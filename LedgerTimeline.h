@@ -0,0 +1,91 @@
+#pragma once
+#include "Ledger.h"
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+// Ledger row position in (day, sequence) order
+struct TimelineEntry {
+    int32_t day;
+    uint32_t seq;
+    uint32_t row;   // Current ledger row
+};
+
+// Ledger rows kept sorted by (day, sequence): chronological, and in
+// insertion order within a day. Maintained incrementally, so reading the
+// newest N rows or every row between two dates is two binary searches and a
+// contiguous walk, with no copying or sorting.
+class DateOrderedRows {
+public:
+    using const_iterator = std::vector<TimelineEntry>::const_iterator;
+    using const_reverse_iterator = std::vector<TimelineEntry>::const_reverse_iterator;
+
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+    const_reverse_iterator rbegin() const { return entries.rbegin(); }   // Newest first
+    const_reverse_iterator rend() const { return entries.rend(); }
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+
+    // Entries whose day falls in the range, oldest first
+    std::span<const TimelineEntry> Range(const DayRange& days) const;
+
+    void Clear() { entries.clear(); }
+    void Append(size_t row);    // Unordered bulk add; call Sort() when done
+    void Sort();
+    void Insert(size_t row);
+    void Erase(size_t row);
+    void Renumber(size_t from, size_t to);
+    void EraseDead();           // Drops entries whose row is no longer live
+
+private:
+    std::vector<TimelineEntry>::iterator Find(size_t row);
+
+    std::vector<TimelineEntry> entries;
+};
+
+// Every ledger row in date order
+class LedgerTimeline : public LedgerIndex {
+public:
+    using Entry = TimelineEntry;
+    using const_iterator = DateOrderedRows::const_iterator;
+    using const_reverse_iterator = DateOrderedRows::const_reverse_iterator;
+
+    const_iterator begin() const { return rows.begin(); }
+    const_iterator end() const { return rows.end(); }
+    const_reverse_iterator rbegin() const { return rows.rbegin(); }   // Newest first
+    const_reverse_iterator rend() const { return rows.rend(); }
+    size_t size() const { return rows.size(); }
+
+    std::span<const TimelineEntry> Range(const DayRange& days) const { return rows.Range(days); }
+
+    void OnRebuilt() override;
+    void OnCleared() override;
+    void OnRowAdded(size_t row) override;
+    void OnRowRemoving(size_t row) override;
+    void OnRowsRemoved(std::span<const uint32_t> rows) override;
+    void OnRowMoved(size_t from, size_t to) override;
+
+private:
+    DateOrderedRows rows;
+};
+
+// One date-ordered list per user, for per-user date range queries
+class UserTimeline : public LedgerIndex {
+public:
+    // The user's rows in the range, oldest first. Valid until the next ledger change.
+    std::span<const TimelineEntry> Range(SymbolId user, const DayRange& days) const;
+
+    void OnRebuilt() override;
+    void OnCleared() override;
+    void OnRowAdded(size_t row) override;
+    void OnRowRemoving(size_t row) override;
+    void OnRowsRemoved(std::span<const uint32_t> rows) override;
+    void OnRowMoved(size_t from, size_t to) override;
+
+private:
+    std::unordered_map<SymbolId, DateOrderedRows> byUser;
+};
+
+extern LedgerTimeline ledgerTimeline;
+extern UserTimeline userTimeline;
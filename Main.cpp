@@ -6,11 +6,17 @@
 #include <gdiplus.h>
 
 #include "TrackerWindow.h"
+#include "Benchmarks.h"
 
 using namespace Gdiplus;
 
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
 {
+    // Benchmark runs replace the UI entirely
+    if (strstr(lpCmdLine, "/benchmark")) {
+        return Benchmarks::WriteReport(L"benchmarks.txt") ? 0 : 1;
+    }
+
     // Initialize GDI+
     GdiplusStartupInput gdiplusStartupInput;
     ULONG_PTR gdiplusToken;
@@ -0,0 +1,216 @@
+#include "QuantileIndex.h"
+#include "CurrencyManager.h"
+#include "LedgerTimeline.h"
+#include "Utils.h"
+#include <algorithm>
+#include <cmath>
+
+QuantileIndex quantileIndex;
+
+// QuantileSketch
+
+void QuantileSketch::Add(double value) {
+    min = Empty() ? value : std::min(min, value);
+    max = Empty() ? value : std::max(max, value);
+    buffer.push_back({ value, 1.0 });
+    totalWeight += 1.0;
+
+    if (buffer.size() >= static_cast<size_t>(compression)) Compress();
+}
+
+void QuantileSketch::Merge(const QuantileSketch& other, double scale) {
+    if (other.Empty()) return;
+
+    min = Empty() ? other.min * scale : std::min(min, other.min * scale);
+    max = Empty() ? other.max * scale : std::max(max, other.max * scale);
+    for (const Centroid& centroid : other.buffer) buffer.push_back({ centroid.mean * scale, centroid.weight });
+    totalWeight += other.totalWeight;
+
+    Compress(other.centroids, scale);
+}
+
+// Folds the buffer, and any incoming centroids multiplied by scale, into the
+// centroids. Only the buffer needs sorting; the centroid lists are already
+// sorted and merge in linear time. One pass then merges neighbours while the
+// merged centroid stays within its limit.
+void QuantileSketch::Compress(std::span<const Centroid> incoming, double scale) {
+    if (buffer.empty() && incoming.empty()) return;
+
+    auto byMean = [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; };
+    std::sort(buffer.begin(), buffer.end(), byMean);
+
+    auto sortedEnd = static_cast<std::ptrdiff_t>(buffer.size());
+    buffer.insert(buffer.end(), centroids.begin(), centroids.end());
+    std::inplace_merge(buffer.begin(), buffer.begin() + sortedEnd, buffer.end(), byMean);
+
+    sortedEnd = static_cast<std::ptrdiff_t>(buffer.size());
+    for (const Centroid& centroid : incoming) buffer.push_back({ centroid.mean * scale, centroid.weight });
+    std::inplace_merge(buffer.begin(), buffer.begin() + sortedEnd, buffer.end(), byMean);
+    centroids.clear();
+
+    // A centroid centred at quantile q may weigh 2 pi N sqrt(q (1 - q)) / compression,
+    // about one unit of the scale k(q) = compression / (2 pi) * asin(2q - 1).
+    // The scale is steep near 0 and 1, so centroids there stay small. It
+    // spans compression / 2 units, so about that many centroids are kept.
+    const double PI = 3.14159265358979323846;
+    double sizeFactor = 2.0 * PI * totalWeight / compression;
+    double emitted = 0.0;   // Weight of the centroids already output
+    Centroid current = buffer[0];
+    for (size_t i = 1; i < buffer.size(); ++i) {
+        const Centroid& next = buffer[i];
+        double weight = current.weight + next.weight;
+        double q = (emitted + weight / 2.0) / totalWeight;
+        if (weight <= sizeFactor * std::sqrt(q * (1.0 - q))) {
+            current.weight = weight;
+            current.mean += (next.mean - current.mean) * next.weight / weight;
+        }
+        else {
+            emitted += current.weight;
+            centroids.push_back(current);
+            current = next;
+        }
+    }
+    centroids.push_back(current);
+    buffer.clear();
+}
+
+double QuantileSketch::Quantile(double q) const {
+    if (Empty()) return 0.0;
+    if (!buffer.empty()) {
+        QuantileSketch compressed(*this);
+        compressed.Compress();
+        return compressed.Quantile(q);
+    }
+
+    // Piecewise linear through (0, min), each centroid's mean at the middle
+    // of its weight, and (total weight, max). Single values land exactly.
+    double index = std::clamp(q, 0.0, 1.0) * totalWeight;
+    double previousPosition = 0.0;
+    double previousValue = min;
+    double cumulative = 0.0;
+    for (const Centroid& centroid : centroids) {
+        double position = cumulative + centroid.weight / 2.0;
+        if (index < position) {
+            return previousValue + (centroid.mean - previousValue) * (index - previousPosition) / (position - previousPosition);
+        }
+        previousPosition = position;
+        previousValue = centroid.mean;
+        cumulative += centroid.weight;
+    }
+    if (totalWeight <= previousPosition) return max;
+    return previousValue + (max - previousValue) * (index - previousPosition) / (totalWeight - previousPosition);
+}
+
+// QuantileIndex
+static bool SameCell(const QuantileCell& cell, size_t row) {
+    return cell.category == ledger.Categories()[row] && cell.currency == ledger.Currencies()[row];
+}
+
+static bool IsDatedExpense(size_t row) {
+    return !(ledger.Flags()[row] & LEDGER_INCOME) && ledger.Days()[row] != INVALID_DAY;
+}
+
+QuantileSketch QuantileIndex::Expenses(SymbolId user, SymbolId category, const DayRange& days, CurrencyType target) const {
+    QuantileSketch result;
+
+    auto userIt = users.find(user);
+    if (userIt == users.end() || days.first > days.last) return result;
+    auto& months = userIt->second;
+
+    auto first = days.first == INT32_MIN ? months.begin() : months.lower_bound(DayNumberToMonthIndex(days.first));
+    auto last = days.last == INT32_MAX ? months.end() : months.upper_bound(DayNumberToMonthIndex(days.last));
+    for (auto it = first; it != last; ++it) {
+        double factors[CURRENCY_TYPE_COUNT];
+        CurrencyManager::FactorsOn(target, MonthIndexToMidDay(it->first), factors);
+        DayRange monthDays(MonthIndexToDayNumber(it->first), MonthIndexToDayNumber(it->first + 1) - 1);
+
+        if (days.first <= monthDays.first && monthDays.last <= days.last) {
+            for (auto& cell : it->second) {
+                if (category != INVALID_SYMBOL && cell.category != category) continue;
+                result.Merge(cell.sketch, factors[cell.currency]);
+            }
+            continue;
+        }
+
+        // The period starts or ends inside this month, so its part of the
+        // month is read row by row
+        DayRange overlap(std::max(days.first, monthDays.first), std::min(days.last, monthDays.last));
+        for (const auto& entry : userTimeline.Range(user, overlap)) {
+            if (!IsDatedExpense(entry.row)) continue;
+            if (category != INVALID_SYMBOL && ledger.Categories()[entry.row] != category) continue;
+            result.Add(ledger.Amounts()[entry.row] * factors[ledger.Currencies()[entry.row]]);
+        }
+    }
+
+    return result;
+}
+
+void QuantileIndex::Add(size_t row) {
+    if (!IsDatedExpense(row)) return;
+
+    auto& month = users[ledger.Users()[row]][DayNumberToMonthIndex(ledger.Days()[row])];
+    auto it = std::find_if(month.begin(), month.end(), [row](const QuantileCell& cell) { return SameCell(cell, row); });
+    if (it == month.end()) {
+        it = month.insert(month.end(), QuantileCell{ ledger.Categories()[row], ledger.Currencies()[row], QuantileSketch() });
+    }
+    it->sketch.Add(ledger.Amounts()[row]);
+}
+
+void QuantileIndex::MarkStale(size_t row) {
+    if (IsDatedExpense(row)) staleMonths.emplace_back(ledger.Users()[row], DayNumberToMonthIndex(ledger.Days()[row]));
+}
+
+// Rebuilds every cell of the months that lost an expense. The user timeline
+// is attached first, so it no longer lists the removed rows.
+void QuantileIndex::RescanStaleMonths() {
+    std::sort(staleMonths.begin(), staleMonths.end());
+    staleMonths.erase(std::unique(staleMonths.begin(), staleMonths.end()), staleMonths.end());
+
+    for (const auto& [user, monthIndex] : staleMonths) {
+        auto userIt = users.find(user);
+        if (userIt == users.end()) continue;
+        auto monthIt = userIt->second.find(monthIndex);
+        if (monthIt == userIt->second.end()) continue;
+
+        auto& month = monthIt->second;
+        for (auto& cell : month) cell.sketch = QuantileSketch();
+        DayRange days(MonthIndexToDayNumber(monthIndex), MonthIndexToDayNumber(monthIndex + 1) - 1);
+        for (const auto& entry : userTimeline.Range(user, days)) {
+            if (!IsDatedExpense(entry.row)) continue;
+            auto it = std::find_if(month.begin(), month.end(), [&entry](const QuantileCell& cell) { return SameCell(cell, entry.row); });
+            if (it != month.end()) it->sketch.Add(ledger.Amounts()[entry.row]);
+        }
+
+        // Cells and months left without expenses are dropped
+        month.erase(std::remove_if(month.begin(), month.end(), [](const QuantileCell& cell) { return cell.sketch.Empty(); }), month.end());
+        if (month.empty()) userIt->second.erase(monthIt);
+    }
+    staleMonths.clear();
+}
+
+void QuantileIndex::OnRebuilt() {
+    OnCleared();
+    ledger.ForEachRow([this](size_t row) { Add(row); });
+}
+
+void QuantileIndex::OnCleared() {
+    users.clear();
+}
+
+void QuantileIndex::OnRowAdded(size_t row) {
+    Add(row);
+}
+
+void QuantileIndex::OnRowRemoving(size_t row) {
+    MarkStale(row);
+    RescanStaleMonths();
+}
+
+void QuantileIndex::OnRowsRemoved(std::span<const uint32_t> rows) {
+    for (uint32_t row : rows) MarkStale(row);
+    RescanStaleMonths();
+}
+
+void QuantileIndex::OnRowMoved(size_t from, size_t to) {
+    // Cells hold no row numbers
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include "Ledger.h"
+#include <map>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+// Accuracy of quantile sketches: about half this many centroids are kept, and
+// the error is smallest near the tails
+const double QUANTILE_COMPRESSION = 100.0;
+
+struct Centroid {
+    double mean;
+    double weight;
+};
+
+// t-digest: a distribution summarized as weighted centroids, small ones near
+// the tails and larger ones near the median. Memory stays bounded however
+// many values are added, and two sketches merge into one summarizing both,
+// so sketches of months combine into any longer period. Up to a few dozen
+// values are kept exactly.
+class QuantileSketch {
+public:
+    explicit QuantileSketch(double compression = QUANTILE_COMPRESSION) : compression(compression) {}
+
+    void Add(double value);
+
+    // Adds every value summarized by other, multiplied by scale (> 0), such as
+    // an exchange rate
+    void Merge(const QuantileSketch& other, double scale = 1.0);
+
+    double Count() const { return totalWeight; }
+    bool Empty() const { return totalWeight == 0.0; }
+    double Min() const { return min; }
+    double Max() const { return max; }
+
+    // Approximate value below which fraction q (0..1) of the values fall,
+    // interpolated between centroids; 0 if empty
+    double Quantile(double q) const;
+
+private:
+    void Compress(std::span<const Centroid> incoming = {}, double scale = 1.0);
+
+    double compression;
+    std::vector<Centroid> centroids;   // Sorted by mean
+    std::vector<Centroid> buffer;      // Added or merged since the last Compress
+    double totalWeight = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+};
+
+// Sketch of one user's expenses in one month that share a category and a
+// currency. Amounts are in that currency.
+struct QuantileCell {
+    SymbolId category;
+    uint8_t currency;
+    QuantileSketch sketch;
+};
+
+// User x month x category x currency quantile sketches of the ledger's dated
+// expenses, updated as expenses are added. Medians and percentiles of any
+// period merge that period's month sketches instead of sorting its
+// expenses; only the partial months at either end of it are read row by row.
+// A sketch cannot remove a value, so removing an expense rebuilds the cells
+// of its month from that month's rows during the removal notification.
+// Queries only read, so they can run concurrently while the ledger is not
+// changing.
+class QuantileIndex : public LedgerIndex {
+public:
+    // Distribution of the user's expenses in the days, of one category or of
+    // all (INVALID_SYMBOL), in the target currency at mid-month rates
+    QuantileSketch Expenses(SymbolId user, SymbolId category, const DayRange& days, CurrencyType target) const;
+
+    void OnRebuilt() override;
+    void OnCleared() override;
+    void OnRowAdded(size_t row) override;
+    void OnRowRemoving(size_t row) override;
+    void OnRowsRemoved(std::span<const uint32_t> rows) override;
+    void OnRowMoved(size_t from, size_t to) override;
+
+private:
+    void Add(size_t row);
+    void MarkStale(size_t row);
+    void RescanStaleMonths();
+
+    std::unordered_map<SymbolId, std::map<int, std::vector<QuantileCell>>> users;
+    std::vector<std::pair<SymbolId, int>> staleMonths;   // Months that lost an expense
+};
+
+extern QuantileIndex quantileIndex;
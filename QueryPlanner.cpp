@@ -0,0 +1,300 @@
+#include "QueryPlanner.h"
+#include "LedgerTimeline.h"
+#include "CategoryTagIndex.h"
+#include "TextIndex.h"
+#include "AmountIndex.h"
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <optional>
+#include <sstream>
+
+bool traceQueryPlans = false;
+
+// Relative cost of checking one row against a predicate. Column compares
+// cost 1; categories and tags search a short list; text searches the row's
+// cached string.
+static double CheckCost(FilterPredicate predicate) {
+    switch (predicate) {
+    case FilterPredicate::Category: return 2.0;
+    case FilterPredicate::Tag: return 4.0;
+    case FilterPredicate::Text: return 20.0;
+    default: return 1.0;
+    }
+}
+
+// Cost per estimated row of driving from a row set or amount range rather
+// than the timeline: the rows are collected, then sorted by date
+const double INDEX_DRIVER_COST = 2.0;
+
+static const wchar_t* PredicateName(FilterPredicate predicate) {
+    switch (predicate) {
+    case FilterPredicate::Kind: return L"kind";
+    case FilterPredicate::User: return L"user";
+    case FilterPredicate::Date: return L"date";
+    case FilterPredicate::Category: return L"category";
+    case FilterPredicate::Tag: return L"tag";
+    case FilterPredicate::Text: return L"text";
+    case FilterPredicate::Amount: return L"amount";
+    }
+    return L"?";
+}
+
+static const wchar_t* AccessName(PlanAccess access) {
+    switch (access) {
+    case PlanAccess::Driver: return L"driver";
+    case PlanAccess::Intersect: return L"intersect";
+    case PlanAccess::Residual: return L"residual";
+    }
+    return L"?";
+}
+
+static bool IsIndexed(FilterPredicate predicate) {
+    return predicate == FilterPredicate::Category || predicate == FilterPredicate::Tag
+        || predicate == FilterPredicate::Text || predicate == FilterPredicate::Amount;
+}
+
+QueryPlan::QueryPlan(const FilterCriteria& criteria, const std::wstring& userId, bool incomes)
+    : income(incomes), anyUser(userId.empty()), userSymbol(SymbolTable::Find(userId)),
+    days(ToDayRange(criteria.dateRange)), foldedText(FoldText(criteria.searchText)),
+    minAmount(criteria.minAmount), maxAmount(criteria.maxAmount) {
+    // A value that was never interned cannot match any record
+    if (!anyUser && userSymbol == INVALID_SYMBOL) noMatches = true;
+
+    if (!income) {
+        categorySymbols = FindSymbols(criteria.categories);
+        if (!criteria.categories.empty() && categorySymbols.empty()) noMatches = true;
+    }
+
+    tagSymbols = FindSymbols(criteria.tags);
+    if (!criteria.tags.empty() && tagSymbols.empty()) noMatches = true;
+
+    Plan();
+}
+
+void QueryPlan::Plan() {
+    size_t live = ledger.LiveCount();
+    auto add = [&](FilterPredicate predicate, size_t estimate, double selectivity) {
+        steps.push_back({ predicate, PlanAccess::Residual, estimate, selectivity, CheckCost(predicate) });
+    };
+    auto fraction = [live](size_t rows) { return live == 0 ? 0.0 : std::min(1.0, double(rows) / live); };
+
+    // Estimates
+    size_t kindRows = income ? incomes.size() : expenses.size();
+    add(FilterPredicate::Kind, kindRows, fraction(kindRows));
+
+    if (!anyUser) {
+        size_t userRows = userTimeline.Range(userSymbol, DayRange()).size();
+        add(FilterPredicate::User, userRows, fraction(userRows));
+    }
+
+    size_t dateRows = ledgerTimeline.Range(days).size();
+    if (dateRows < live) add(FilterPredicate::Date, dateRows, fraction(dateRows));
+
+    if (!categorySymbols.empty()) {
+        size_t rows = categoryTagIndex.CategoryRowCount(categorySymbols);
+        add(FilterPredicate::Category, rows, fraction(rows));
+    }
+
+    if (!tagSymbols.empty()) {
+        size_t rows = std::min(categoryTagIndex.TagRowCount(tagSymbols), live);
+        add(FilterPredicate::Tag, rows, fraction(rows));
+    }
+
+    if (!foldedText.empty()) {
+        size_t rows = textIndex.EstimateMatches(foldedText);
+        add(FilterPredicate::Text, rows, fraction(rows));
+    }
+
+    // Relative to rows of this kind, so the default range rejects nothing
+    size_t amountRows = amountIndex.Rows(income).Range(minAmount, maxAmount).size();
+    add(FilterPredicate::Amount, amountRows, kindRows == 0 ? 0.0 : double(amountRows) / kindRows);
+
+    // Driver: the user's (or everyone's) timeline over the date range, unless
+    // an indexed row set or amount range is cheaper to collect and sort.
+    // The amount lists are per kind and user, so that range settles both.
+    size_t timelineRows = anyUser ? dateRows : userTimeline.Range(userSymbol, days).size();
+    double driverCost = static_cast<double>(timelineRows);
+    size_t driverRows = timelineRows;
+
+    auto indexRows = [this](const PlanStep& step) {
+        return step.predicate == FilterPredicate::Amount ? AmountRange().size() : step.estimate;
+    };
+
+    for (const auto& step : steps) {
+        if (!IsIndexed(step.predicate)) continue;
+
+        size_t rows = indexRows(step);
+        double cost = rows * INDEX_DRIVER_COST;
+        if (cost < driverCost) {
+            driverCost = cost;
+            driverRows = rows;
+            driver = step.predicate;
+        }
+    }
+
+    if (driver == FilterPredicate::Date) {
+        // The timeline settles user and date together
+        if (std::none_of(steps.begin(), steps.end(), [](const PlanStep& s) { return s.predicate == FilterPredicate::Date; })) {
+            steps.push_back({ FilterPredicate::Date, PlanAccess::Residual, timelineRows, fraction(timelineRows), 1.0 });
+        }
+        for (auto& step : steps) {
+            if (step.predicate == FilterPredicate::Date || step.predicate == FilterPredicate::User) {
+                step.access = PlanAccess::Driver;
+            }
+        }
+    }
+    else if (driver == FilterPredicate::Amount) {
+        for (auto& step : steps) {
+            if (step.predicate == FilterPredicate::Kind || step.predicate == FilterPredicate::User) {
+                step.access = PlanAccess::Driver;
+            }
+        }
+    }
+
+    for (auto& step : steps) {
+        if (step.predicate == driver) step.access = PlanAccess::Driver;
+        else if (IsIndexed(step.predicate) && indexRows(step) < driverRows * step.cost) step.access = PlanAccess::Intersect;
+    }
+
+    // Residual order: fewest checks per rejected row first; checks that
+    // reject nothing go last
+    auto rank = [](const PlanStep& step) {
+        return step.selectivity >= 1.0 ? std::numeric_limits<double>::infinity() : step.cost / (1.0 - step.selectivity);
+    };
+    std::stable_sort(steps.begin(), steps.end(), [&](const PlanStep& a, const PlanStep& b) {
+        if (a.access != b.access) return a.access < b.access;
+        return rank(a) < rank(b);
+    });
+
+    std::vector<PlanStep> byRank = steps;
+    std::stable_sort(byRank.begin(), byRank.end(), [&](const PlanStep& a, const PlanStep& b) { return rank(a) < rank(b); });
+    for (const auto& step : byRank) checkOrder.push_back(step.predicate);
+}
+
+// The current user's (or everyone's) rows of this kind in the amount range
+std::span<const AmountEntry> QueryPlan::AmountRange() const {
+    return amountIndex.Rows(income, anyUser ? ALL_SYMBOLS : userSymbol).Range(minAmount, maxAmount);
+}
+
+std::vector<uint32_t> QueryPlan::Execute() {
+    std::vector<uint32_t> rows;
+    rowsTouched = 0;
+    rowsMatched = 0;
+    if (noMatches) return rows;
+
+    std::optional<RowBitmap> filter;
+    std::vector<FilterPredicate> residuals;
+    for (const auto& step : steps) {
+        if (step.access == PlanAccess::Intersect) {
+            if (filter) *filter &= Lookup(step.predicate);
+            else filter = Lookup(step.predicate);
+        }
+        else if (step.access == PlanAccess::Residual) {
+            residuals.push_back(step.predicate);
+        }
+    }
+
+    auto accept = [&](uint32_t row) {
+        ++rowsTouched;
+        if (filter && !filter->Contains(row)) return;
+        for (FilterPredicate predicate : residuals) {
+            if (!Check(predicate, row)) return;
+        }
+        rows.push_back(row);
+    };
+
+    if (driver == FilterPredicate::Date) {
+        auto range = anyUser ? ledgerTimeline.Range(days) : userTimeline.Range(userSymbol, days);
+        for (const auto& entry : range) accept(entry.row);
+    }
+    else {
+        if (driver == FilterPredicate::Amount) {
+            for (const auto& entry : AmountRange()) accept(entry.row);
+        }
+        else {
+            RowBitmap candidates = Lookup(driver);
+            if (filter) {
+                candidates &= *filter;
+                filter.reset();
+            }
+            candidates.ForEach(accept);
+        }
+
+        auto dayColumn = ledger.Days();
+        auto seqColumn = ledger.Sequences();
+        std::sort(rows.begin(), rows.end(), [&](uint32_t a, uint32_t b) {
+            return dayColumn[a] != dayColumn[b] ? dayColumn[a] < dayColumn[b] : seqColumn[a] < seqColumn[b];
+        });
+    }
+
+    rowsMatched = rows.size();
+    return rows;
+}
+
+bool QueryPlan::Matches(uint32_t row) const {
+    if (noMatches) return false;
+    for (FilterPredicate predicate : checkOrder) {
+        if (!Check(predicate, row)) return false;
+    }
+    return true;
+}
+
+std::wstring QueryPlan::Explain() const {
+    std::wostringstream out;
+    out << L"Plan for " << (income ? L"incomes" : L"expenses") << L" over " << ledger.LiveCount() << L" rows";
+    if (noMatches) {
+        out << L": nothing can match, the criteria name an unknown user, category or tag";
+        return out.str();
+    }
+
+    out << std::fixed << std::setprecision(3);
+    for (const auto& step : steps) {
+        out << L"\n  " << std::left << std::setw(10) << AccessName(step.access)
+            << std::setw(9) << PredicateName(step.predicate)
+            << L" est " << step.estimate << L" sel " << step.selectivity
+            << L" cost " << std::setprecision(0) << step.cost << std::setprecision(3);
+    }
+    out << L"\n  touched " << rowsTouched << L" rows, matched " << rowsMatched;
+    return out.str();
+}
+
+bool QueryPlan::Check(FilterPredicate predicate, uint32_t row) const {
+    switch (predicate) {
+    case FilterPredicate::Kind:
+        return ((ledger.Flags()[row] & LEDGER_INCOME) != 0) == income;
+    case FilterPredicate::User:
+        return anyUser || ledger.Users()[row] == userSymbol;
+    case FilterPredicate::Date:
+        return days.Contains(ledger.Days()[row]);
+    case FilterPredicate::Category:
+        return std::find(categorySymbols.begin(), categorySymbols.end(), ledger.Categories()[row]) != categorySymbols.end();
+    case FilterPredicate::Tag: {
+        auto tags = ledger.Tags(row);
+        return std::any_of(tags.begin(), tags.end(), [this](SymbolId tag) {
+            return std::find(tagSymbols.begin(), tagSymbols.end(), tag) != tagSymbols.end();
+        });
+    }
+    case FilterPredicate::Text:
+        return textIndex.RowContains(row, foldedText);
+    case FilterPredicate::Amount: {
+        double amount = ledger.Amounts()[row];
+        return amount >= minAmount && amount <= maxAmount;
+    }
+    }
+    return false;
+}
+
+RowBitmap QueryPlan::Lookup(FilterPredicate predicate) const {
+    switch (predicate) {
+    case FilterPredicate::Category: return categoryTagIndex.AnyCategory(categorySymbols);
+    case FilterPredicate::Tag: return categoryTagIndex.AnyTag(tagSymbols);
+    case FilterPredicate::Text: return textIndex.Find(foldedText);
+    case FilterPredicate::Amount: {
+        RowBitmap rows;
+        for (const auto& entry : AmountRange()) rows.Add(entry.row);
+        return rows;
+    }
+    default: return RowBitmap();
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "Ledger.h"
+#include "RowBitmap.h"
+#include "AmountIndex.h"
+#include <span>
+#include <string>
+#include <vector>
+
+// What a filter can restrict on: the FilterCriteria fields plus the row kind
+// and user implied by the call
+enum class FilterPredicate : uint8_t {
+    Kind,       // Expense or income row
+    User,
+    Date,
+    Category,
+    Tag,
+    Text,
+    Amount
+};
+
+// How a plan evaluates a predicate
+enum class PlanAccess : uint8_t {
+    Driver,     // Produces the candidate rows
+    Intersect,  // Row set ANDed with the candidates before any row is checked
+    Residual    // Checked row by row on the candidates
+};
+
+struct PlanStep {
+    FilterPredicate predicate;
+    PlanAccess access;
+    size_t estimate;        // Rows expected to pass this predicate alone
+    double selectivity;     // estimate as a fraction of the live rows
+    double cost;            // Relative cost of checking one row
+};
+
+// Cost-based plan for one FilterCriteria over the ledger.
+// The constructor resolves the criteria and estimates each predicate from the
+// indexes: timeline and amount range sizes, bitmap cardinalities and trigram
+// counts. The cheapest access path drives; other indexed predicates are
+// intersected when building their row set costs less than checking them on
+// every candidate; the rest are checked per row, those rejecting the most
+// rows per unit of cost first.
+class QueryPlan {
+public:
+    // An empty userId matches every user. Categories only apply to expenses.
+    QueryPlan(const FilterCriteria& criteria, const std::wstring& userId, bool incomes);
+
+    // Matching rows, oldest first
+    std::vector<uint32_t> Execute();
+
+    // Checks every predicate on one live row, in residual order
+    bool Matches(uint32_t row) const;
+
+    // The chosen plan with its estimates, and the row counts of the last Execute()
+    std::wstring Explain() const;
+
+    std::span<const PlanStep> Steps() const { return steps; }
+    size_t RowsTouched() const { return rowsTouched; }
+    size_t RowsMatched() const { return rowsMatched; }
+
+private:
+    void Plan();
+    std::span<const AmountEntry> AmountRange() const;
+    bool Check(FilterPredicate predicate, uint32_t row) const;
+    RowBitmap Lookup(FilterPredicate predicate) const;
+
+    bool income;
+    bool anyUser;
+    bool noMatches = false;     // The criteria name a user, category or tag that no row has
+    SymbolId userSymbol;
+    DayRange days;
+    std::vector<SymbolId> categorySymbols;
+    std::vector<SymbolId> tagSymbols;
+    std::wstring foldedText;
+    double minAmount;
+    double maxAmount;
+
+    FilterPredicate driver = FilterPredicate::Date;
+    std::vector<PlanStep> steps;                // Driver, intersections, then residuals in check order
+    std::vector<FilterPredicate> checkOrder;    // Every predicate, for Matches()
+    size_t rowsTouched = 0;
+    size_t rowsMatched = 0;
+};
+
+// When set, FilterExpenses and FilterIncomes log each plan through LogInfo
+extern bool traceQueryPlans;
@@ -0,0 +1,144 @@
+#include "RollupCube.h"
+#include "LedgerTimeline.h"
+#include "Utils.h"
+#include <algorithm>
+#include <limits>
+
+RollupCube rollupCube;
+
+static bool SameCell(const RollupCell& cell, size_t row) {
+    return cell.category == ledger.Categories()[row] && cell.currency == ledger.Currencies()[row]
+        && cell.income == ((ledger.Flags()[row] & LEDGER_INCOME) != 0);
+}
+
+const std::map<int, RollupMonth>& RollupCube::Months(SymbolId user) const {
+    static const std::map<int, RollupMonth> none;
+    auto it = users.find(user);
+    return it != users.end() ? it->second : none;
+}
+
+void RollupCube::Add(size_t row) {
+    int32_t day = ledger.Days()[row];
+    if (day == INVALID_DAY) return;
+
+    SymbolId user = ledger.Users()[row];
+    int monthIndex = DayNumberToMonthIndex(day);
+    Touch(user, monthIndex);
+
+    RollupMonth& month = users[user][monthIndex];
+    auto it = std::find_if(month.begin(), month.end(), [row](const RollupCell& cell) { return SameCell(cell, row); });
+    if (it == month.end()) {
+        RollupCell cell{};
+        cell.category = ledger.Categories()[row];
+        cell.currency = ledger.Currencies()[row];
+        cell.income = (ledger.Flags()[row] & LEDGER_INCOME) != 0;
+        cell.min = std::numeric_limits<double>::max();
+        cell.max = std::numeric_limits<double>::lowest();
+        it = month.insert(month.end(), cell);
+    }
+
+    double amount = ledger.Amounts()[row];
+    it->count++;
+    it->sum += amount;
+    it->min = std::min(it->min, amount);
+    it->max = std::max(it->max, amount);
+}
+
+void RollupCube::Subtract(size_t row) {
+    int32_t day = ledger.Days()[row];
+    if (day == INVALID_DAY) return;
+
+    auto userIt = users.find(ledger.Users()[row]);
+    if (userIt == users.end()) return;
+    auto monthIt = userIt->second.find(DayNumberToMonthIndex(day));
+    if (monthIt == userIt->second.end()) return;
+    Touch(userIt->first, monthIt->first);
+    RollupMonth& month = monthIt->second;
+    auto it = std::find_if(month.begin(), month.end(), [row](const RollupCell& cell) { return SameCell(cell, row); });
+    if (it == month.end()) return;
+
+    // Empty cells and months are dropped, so Months() lists only months with rows
+    if (--it->count == 0) {
+        month.erase(it);
+        if (month.empty()) userIt->second.erase(monthIt);
+        return;
+    }
+
+    double amount = ledger.Amounts()[row];
+    it->sum -= amount;
+    if (amount <= it->min || amount >= it->max) staleExtrema.emplace_back(userIt->first, monthIt->first);
+}
+
+// Recomputes the min and max of every cell in the months that lost a row at
+// either end. The user timeline is attached first, so it no longer lists the
+// removed rows.
+void RollupCube::RescanExtrema() {
+    std::sort(staleExtrema.begin(), staleExtrema.end());
+    staleExtrema.erase(std::unique(staleExtrema.begin(), staleExtrema.end()), staleExtrema.end());
+
+    for (const auto& [user, monthIndex] : staleExtrema) {
+        auto userIt = users.find(user);
+        if (userIt == users.end()) continue;
+        auto monthIt = userIt->second.find(monthIndex);
+        if (monthIt == userIt->second.end()) continue;
+
+        RollupMonth& month = monthIt->second;
+        for (auto& cell : month) {
+            cell.min = std::numeric_limits<double>::max();
+            cell.max = std::numeric_limits<double>::lowest();
+        }
+        DayRange days(MonthIndexToDayNumber(monthIndex), MonthIndexToDayNumber(monthIndex + 1) - 1);
+        for (const auto& entry : userTimeline.Range(user, days)) {
+            auto it = std::find_if(month.begin(), month.end(), [&entry](const RollupCell& cell) { return SameCell(cell, entry.row); });
+            if (it == month.end()) continue;
+            it->min = std::min(it->min, ledger.Amounts()[entry.row]);
+            it->max = std::max(it->max, ledger.Amounts()[entry.row]);
+        }
+    }
+    staleExtrema.clear();
+}
+
+uint64_t RollupCube::HistoryRevision(SymbolId user) const {
+    auto it = historyChangedAt.find(user);
+    return it != historyChangedAt.end() ? std::max(it->second, rebuiltAt) : rebuiltAt;
+}
+
+void RollupCube::Touch(SymbolId user, int month) {
+    if (month < openMonth) historyChangedAt[user] = ++historyClock;
+}
+
+void RollupCube::OnRebuilt() {
+    OnCleared();
+    openMonth = INT_MIN;
+    ledger.ForEachRow([this](size_t row) { Add(row); });
+    // Everything changed at once; one stamp covers every user
+    historyChangedAt.clear();
+    rebuiltAt = ++historyClock;
+}
+
+void RollupCube::OnCleared() {
+    users.clear();
+    historyChangedAt.clear();
+    rebuiltAt = ++historyClock;
+}
+
+void RollupCube::OnRowAdded(size_t row) {
+    openMonth = CurrentMonthIndex();
+    Add(row);
+}
+
+void RollupCube::OnRowRemoving(size_t row) {
+    openMonth = CurrentMonthIndex();
+    Subtract(row);
+    RescanExtrema();
+}
+
+void RollupCube::OnRowsRemoved(std::span<const uint32_t> rows) {
+    openMonth = CurrentMonthIndex();
+    for (uint32_t row : rows) Subtract(row);
+    RescanExtrema();
+}
+
+void RollupCube::OnRowMoved(size_t from, size_t to) {
+    // Cells hold no row numbers
+}
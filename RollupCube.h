@@ -0,0 +1,62 @@
+#pragma once
+#include "Ledger.h"
+#include <climits>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+// Aggregate of one user's rows in one month that share a kind, a category
+// (source for incomes) and a currency. Amounts are in that currency.
+struct RollupCell {
+    SymbolId category;
+    uint8_t currency;
+    bool income;
+    uint32_t count;
+    double sum;
+    double min;
+    double max;
+};
+
+// Cells of one month, a handful per category in use
+using RollupMonth = std::vector<RollupCell>;
+
+// User x month x category x currency rollup of the ledger's dated rows.
+// Every added, edited or removed row applies its amount as a delta to one
+// cell, so monthly and per-category analytics read months x categories cells
+// instead of every transaction. Sums drift by rounding only until the next
+// Rebuild(). Removing a row at a cell's min or max cannot be applied as a
+// delta, so that month's rows are rescanned for its extrema right away.
+class RollupCube : public LedgerIndex {
+public:
+    // The user's months with rows, by month index (see DayNumberToMonthIndex),
+    // oldest first. Valid until the next ledger change.
+    const std::map<int, RollupMonth>& Months(SymbolId user) const;
+
+    // Changes whenever a cell of one of the user's closed months (before the
+    // current one) changes, or the cube is rebuilt. Models fitted to closed
+    // months stay valid while it holds, however much the open month changes.
+    uint64_t HistoryRevision(SymbolId user) const;
+
+    void OnRebuilt() override;
+    void OnCleared() override;
+    void OnRowAdded(size_t row) override;
+    void OnRowRemoving(size_t row) override;
+    void OnRowsRemoved(std::span<const uint32_t> rows) override;
+    void OnRowMoved(size_t from, size_t to) override;
+
+private:
+    void Add(size_t row);
+    void Subtract(size_t row);
+    void Touch(SymbolId user, int month);
+    void RescanExtrema();
+
+    std::unordered_map<SymbolId, std::map<int, RollupMonth>> users;
+    std::vector<std::pair<SymbolId, int>> staleExtrema;   // Months that lost a row at a cell's min or max
+
+    int openMonth = INT_MIN;   // Current month, read once per notification
+    uint64_t historyClock = 0;
+    uint64_t rebuiltAt = 0;                                   // Clock at the last rebuild or clear
+    std::unordered_map<SymbolId, uint64_t> historyChangedAt;  // Clock at each user's last closed-month change
+};
+
+extern RollupCube rollupCube;
@@ -0,0 +1,216 @@
+#include "RowBitmap.h"
+#include <algorithm>
+#include <iterator>
+
+RowBitmap::RowBitmap(std::span<const uint32_t> rows) {
+    for (uint32_t row : rows) Add(row);
+}
+
+void RowBitmap::Add(uint32_t row) {
+    uint16_t key = uint16_t(row >> 16);
+    uint16_t low = uint16_t(row & 0xFFFF);
+
+    // Rows are mostly added in ascending order, so check the last chunk first
+    Chunk* chunk = (!chunks.empty() && chunks.back().key == key) ? &chunks.back() : FindChunk(key);
+    if (!chunk) {
+        auto pos = std::lower_bound(chunks.begin(), chunks.end(), key,
+            [](const Chunk& c, uint16_t k) { return c.key < k; });
+        chunk = &*chunks.insert(pos, Chunk());
+        chunk->key = key;
+    }
+
+    if (!chunk->bits.empty()) {
+        uint64_t mask = uint64_t(1) << (low & 63);
+        if (!(chunk->bits[low >> 6] & mask)) {
+            chunk->bits[low >> 6] |= mask;
+            chunk->count++;
+        }
+        return;
+    }
+
+    auto& array = chunk->array;
+    if (array.empty() || array.back() < low) {
+        array.push_back(low);
+    }
+    else {
+        auto it = std::lower_bound(array.begin(), array.end(), low);
+        if (*it == low) return;
+        array.insert(it, low);
+    }
+    chunk->count++;
+
+    if (chunk->count > ARRAY_LIMIT) chunk->ToBits();
+}
+
+void RowBitmap::Remove(uint32_t row) {
+    uint16_t low = uint16_t(row & 0xFFFF);
+    Chunk* chunk = FindChunk(uint16_t(row >> 16));
+    if (!chunk || !chunk->Contains(low)) return;
+
+    if (!chunk->bits.empty()) {
+        chunk->bits[low >> 6] &= ~(uint64_t(1) << (low & 63));
+        // Convert back well below the limit so add/remove at the edge does not thrash
+        if (--chunk->count < ARRAY_LIMIT / 2) chunk->ToArray();
+    }
+    else {
+        chunk->array.erase(std::lower_bound(chunk->array.begin(), chunk->array.end(), low));
+        chunk->count--;
+    }
+
+    if (chunk->count == 0) {
+        chunks.erase(chunks.begin() + (chunk - chunks.data()));
+    }
+}
+
+bool RowBitmap::Contains(uint32_t row) const {
+    const Chunk* chunk = FindChunk(uint16_t(row >> 16));
+    return chunk && chunk->Contains(uint16_t(row & 0xFFFF));
+}
+
+size_t RowBitmap::Cardinality() const {
+    size_t total = 0;
+    for (const auto& chunk : chunks) total += chunk.count;
+    return total;
+}
+
+RowBitmap& RowBitmap::operator|=(const RowBitmap& other) {
+    std::vector<Chunk> merged;
+    merged.reserve(chunks.size() + other.chunks.size());
+
+    auto a = chunks.begin();
+    auto b = other.chunks.begin();
+    while (a != chunks.end() || b != other.chunks.end()) {
+        if (b == other.chunks.end() || (a != chunks.end() && a->key < b->key)) {
+            merged.push_back(std::move(*a++));
+        }
+        else if (a == chunks.end() || b->key < a->key) {
+            merged.push_back(*b++);
+        }
+        else {
+            OrInto(*a, *b++);
+            merged.push_back(std::move(*a++));
+        }
+    }
+
+    chunks.swap(merged);
+    return *this;
+}
+
+RowBitmap& RowBitmap::operator&=(const RowBitmap& other) {
+    size_t kept = 0;
+    for (auto& chunk : chunks) {
+        const Chunk* match = other.FindChunk(chunk.key);
+        if (!match) continue;
+
+        AndInto(chunk, *match);
+        if (chunk.count > 0) {
+            if (&chunks[kept] != &chunk) chunks[kept] = std::move(chunk);
+            kept++;
+        }
+    }
+
+    chunks.resize(kept);
+    return *this;
+}
+
+std::vector<uint32_t> RowBitmap::ToVector() const {
+    std::vector<uint32_t> rows;
+    rows.reserve(Cardinality());
+    ForEach([&rows](uint32_t row) { rows.push_back(row); });
+    return rows;
+}
+
+RowBitmap::Chunk* RowBitmap::FindChunk(uint16_t key) {
+    auto it = std::lower_bound(chunks.begin(), chunks.end(), key,
+        [](const Chunk& c, uint16_t k) { return c.key < k; });
+    return (it != chunks.end() && it->key == key) ? &*it : nullptr;
+}
+
+const RowBitmap::Chunk* RowBitmap::FindChunk(uint16_t key) const {
+    auto it = std::lower_bound(chunks.begin(), chunks.end(), key,
+        [](const Chunk& c, uint16_t k) { return c.key < k; });
+    return (it != chunks.end() && it->key == key) ? &*it : nullptr;
+}
+
+void RowBitmap::OrInto(Chunk& target, const Chunk& source) {
+    if (target.bits.empty() && source.bits.empty()) {
+        std::vector<uint16_t> merged;
+        merged.reserve(target.array.size() + source.array.size());
+        std::set_union(target.array.begin(), target.array.end(),
+            source.array.begin(), source.array.end(), std::back_inserter(merged));
+        target.array.swap(merged);
+        target.count = uint32_t(target.array.size());
+        if (target.count > ARRAY_LIMIT) target.ToBits();
+        return;
+    }
+
+    target.ToBits();
+    if (source.bits.empty()) {
+        for (uint16_t low : source.array) target.bits[low >> 6] |= uint64_t(1) << (low & 63);
+    }
+    else {
+        for (size_t word = 0; word < CHUNK_WORDS; ++word) target.bits[word] |= source.bits[word];
+    }
+
+    target.count = 0;
+    for (uint64_t word : target.bits) target.count += std::popcount(word);
+}
+
+void RowBitmap::AndInto(Chunk& target, const Chunk& source) {
+    if (target.bits.empty()) {
+        // Array result: keep the entries the other side also has
+        auto end = std::remove_if(target.array.begin(), target.array.end(),
+            [&source](uint16_t low) { return !source.Contains(low); });
+        target.array.erase(end, target.array.end());
+        target.count = uint32_t(target.array.size());
+        return;
+    }
+
+    if (source.bits.empty()) {
+        std::vector<uint16_t> array;
+        array.reserve(source.array.size());
+        for (uint16_t low : source.array) {
+            if (target.Contains(low)) array.push_back(low);
+        }
+        target.bits.clear();
+        target.bits.shrink_to_fit();
+        target.array.swap(array);
+        target.count = uint32_t(target.array.size());
+        return;
+    }
+
+    target.count = 0;
+    for (size_t word = 0; word < CHUNK_WORDS; ++word) {
+        target.bits[word] &= source.bits[word];
+        target.count += std::popcount(target.bits[word]);
+    }
+    if (target.count <= ARRAY_LIMIT) target.ToArray();
+}
+
+// Chunk
+bool RowBitmap::Chunk::Contains(uint16_t low) const {
+    if (!bits.empty()) return (bits[low >> 6] >> (low & 63)) & 1;
+    return std::binary_search(array.begin(), array.end(), low);
+}
+
+void RowBitmap::Chunk::ToBits() {
+    if (!bits.empty()) return;
+
+    bits.assign(CHUNK_WORDS, 0);
+    for (uint16_t low : array) bits[low >> 6] |= uint64_t(1) << (low & 63);
+    array.clear();
+    array.shrink_to_fit();
+}
+
+void RowBitmap::Chunk::ToArray() {
+    if (bits.empty()) return;
+
+    array.reserve(count);
+    for (size_t word = 0; word < CHUNK_WORDS; ++word) {
+        for (uint64_t b = bits[word]; b != 0; b &= b - 1) {
+            array.push_back(uint16_t(word * 64 + std::countr_zero(b)));
+        }
+    }
+    bits.clear();
+    bits.shrink_to_fit();
+}
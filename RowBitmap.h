@@ -0,0 +1,69 @@
+#pragma once
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Compressed set of row ids, roaring style: ids are split into 64K chunks by
+// their high 16 bits and each chunk is stored as a sorted array of low halves
+// while sparse, or as a 65536-bit bitmap once dense. Set operations work
+// chunk by chunk, so AND/OR of sparse sets never touch a full bitmap.
+class RowBitmap {
+public:
+    RowBitmap() = default;
+    explicit RowBitmap(std::span<const uint32_t> rows);
+
+    void Add(uint32_t row);
+    void Remove(uint32_t row);
+    bool Contains(uint32_t row) const;
+    size_t Cardinality() const;
+    bool Empty() const { return chunks.empty(); }
+    void Clear() { chunks.clear(); }
+
+    RowBitmap& operator|=(const RowBitmap& other);
+    RowBitmap& operator&=(const RowBitmap& other);
+    friend RowBitmap operator|(RowBitmap a, const RowBitmap& b) { return a |= b; }
+    friend RowBitmap operator&(RowBitmap a, const RowBitmap& b) { return a &= b; }
+
+    // Calls fn(row) for every row in ascending order
+    template <typename Fn>
+    void ForEach(Fn fn) const {
+        for (const auto& chunk : chunks) {
+            uint32_t high = uint32_t(chunk.key) << 16;
+            if (chunk.bits.empty()) {
+                for (uint16_t low : chunk.array) fn(high | low);
+                continue;
+            }
+            for (size_t word = 0; word < chunk.bits.size(); ++word) {
+                for (uint64_t bits = chunk.bits[word]; bits != 0; bits &= bits - 1) {
+                    fn(high | uint32_t(word * 64 + std::countr_zero(bits)));
+                }
+            }
+        }
+    }
+
+    std::vector<uint32_t> ToVector() const;
+
+private:
+    // Chunks switch to a bitmap above this many entries (8 KB either way)
+    static constexpr size_t ARRAY_LIMIT = 4096;
+    static constexpr size_t CHUNK_WORDS = 65536 / 64;
+
+    struct Chunk {
+        uint16_t key = 0;
+        uint32_t count = 0;
+        std::vector<uint16_t> array;   // Sorted low halves; empty when bits is used
+        std::vector<uint64_t> bits;    // CHUNK_WORDS words, or empty
+
+        bool Contains(uint16_t low) const;
+        void ToBits();
+        void ToArray();
+    };
+
+    Chunk* FindChunk(uint16_t key);
+    const Chunk* FindChunk(uint16_t key) const;
+    static void OrInto(Chunk& target, const Chunk& source);
+    static void AndInto(Chunk& target, const Chunk& source);
+
+    std::vector<Chunk> chunks;   // Sorted by key
+};
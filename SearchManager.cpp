@@ -0,0 +1,56 @@
+#include "FinanceManager.h"
+#include "Ledger.h"
+#include "QueryPlanner.h"
+#include "TextIndex.h"
+#include "TermIndex.h"
+#include <algorithm>
+
+// Rows of the current user matching every criterion, in rank order: rows
+// containing the search text first, newest first, then rows whose words are
+// within a few typos of the query, closest first
+static std::vector<uint32_t> RankedRows(const FilterCriteria& criteria, bool income) {
+    std::vector<uint32_t> ranked;
+
+    // The text is matched here; the plan checks everything else
+    FilterCriteria rest = criteria;
+    rest.searchText.clear();
+    QueryPlan plan(rest, currentUserId, income);
+
+    RowBitmap exact = textIndex.Find(criteria.searchText);
+    exact.ForEach([&](uint32_t row) {
+        if (plan.Matches(row)) ranked.push_back(row);
+    });
+
+    auto dayColumn = ledger.Days();
+    auto seqColumn = ledger.Sequences();
+    std::sort(ranked.begin(), ranked.end(), [&](uint32_t a, uint32_t b) {
+        return dayColumn[a] != dayColumn[b] ? dayColumn[a] > dayColumn[b] : seqColumn[a] > seqColumn[b];
+    });
+
+    for (const auto& fuzzy : termIndex.FindFuzzy(criteria.searchText)) {
+        if (!exact.Contains(fuzzy.row) && plan.Matches(fuzzy.row)) ranked.push_back(fuzzy.row);
+    }
+    return ranked;
+}
+
+// Without search text this is FilterExpenses for the current user; with it,
+// misspelled words still find their rows and the results come back ranked
+std::vector<Expense> SearchManager::SearchExpenses(const FilterCriteria& criteria) {
+    if (criteria.searchText.empty()) return FilterExpenses(criteria, currentUserId);
+
+    std::vector<Expense> result;
+    for (uint32_t row : RankedRows(criteria, false)) {
+        result.push_back(ledger.Row(row).GetExpense());
+    }
+    return result;
+}
+
+std::vector<Income> SearchManager::SearchIncomes(const FilterCriteria& criteria) {
+    if (criteria.searchText.empty()) return FilterIncomes(criteria, currentUserId);
+
+    std::vector<Income> result;
+    for (uint32_t row : RankedRows(criteria, true)) {
+        result.push_back(ledger.Row(row).GetIncome());
+    }
+    return result;
+}
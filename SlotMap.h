@@ -0,0 +1,325 @@
+#pragma once
+#include "Bitmap.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Reference to a slot-map entry. The generation changes every time the slot
+// is freed, so a handle kept past an erase no longer resolves even if the
+// slot has been reused. A default-constructed handle is null.
+struct SlotHandle {
+    uint32_t index;
+    uint32_t generation;
+
+    SlotHandle() : index(0), generation(0) {}
+    SlotHandle(uint32_t i, uint32_t g) : index(i), generation(g) {}
+
+    bool IsNull() const { return generation == 0; }
+    bool operator==(const SlotHandle& other) const = default;
+};
+
+// Unordered container with O(1) insert, erase and handle lookup.
+// Values live in a deque, so their addresses survive later inserts; freed
+// slots are reused. Slot indices stay fixed for the life of the entry and can
+// key parallel arrays sized by SlotCount(). Iteration skips free slots through
+// a live bitmap rather than testing them one by one.
+template <typename T>
+class SlotMap {
+public:
+    template <bool Const>
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const T*, T*>;
+        using reference = std::conditional_t<Const, const T&, T&>;
+        using Owner = std::conditional_t<Const, const SlotMap, SlotMap>;
+
+        Iterator() : owner(nullptr), slot(0) {}
+        Iterator(Owner* map, uint32_t start) : owner(map), slot(start) { SkipFree(); }
+
+        reference operator*() const { return owner->values[slot]; }
+        pointer operator->() const { return &owner->values[slot]; }
+        Iterator& operator++() { ++slot; SkipFree(); return *this; }
+        Iterator operator++(int) { Iterator old = *this; ++*this; return old; }
+        bool operator==(const Iterator& other) const { return slot == other.slot; }
+
+        uint32_t Slot() const { return slot; }
+        SlotHandle Handle() const { return owner->HandleAt(slot); }
+
+    private:
+        void SkipFree() {
+            slot = static_cast<uint32_t>(NextSetBit(owner->liveBits, slot, owner->SlotCount()));
+        }
+
+        Owner* owner;
+        uint32_t slot;
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    SlotHandle Insert(T value) {
+        uint32_t slot;
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+            // Rebuilt rather than assigned, so the value keeps its own allocator
+            std::destroy_at(&values[slot]);
+            std::construct_at(&values[slot], std::move(value));
+        }
+        else {
+            slot = static_cast<uint32_t>(values.size());
+            values.push_back(std::move(value));
+            generations.push_back(0);
+            if (liveBits.size() < BitmapWords(generations.size())) liveBits.push_back(0);
+        }
+
+        // Odd generations mark live slots
+        ++generations[slot];
+        SetBit(liveBits, slot);
+        ++liveCount;
+        return SlotHandle(slot, generations[slot]);
+    }
+
+    bool Erase(SlotHandle handle) {
+        if (!Contains(handle)) return false;
+        EraseSlot(handle.index);
+        return true;
+    }
+
+    // The slot must be live
+    void EraseSlot(uint32_t slot) {
+        // Release the record's strings now rather than on reuse
+        std::destroy_at(&values[slot]);
+        std::construct_at(&values[slot]);
+        ++generations[slot];
+        ClearBit(liveBits, slot);
+        freeSlots.push_back(slot);
+        --liveCount;
+    }
+
+    // The slot must be live; rebuilt in place like a reused slot
+    void Replace(uint32_t slot, T value) {
+        std::destroy_at(&values[slot]);
+        std::construct_at(&values[slot], std::move(value));
+    }
+
+    // nullptr when the handle is null or stale
+    T* Get(SlotHandle handle) { return Contains(handle) ? &values[handle.index] : nullptr; }
+    const T* Get(SlotHandle handle) const { return Contains(handle) ? &values[handle.index] : nullptr; }
+
+    bool Contains(SlotHandle handle) const {
+        return handle.index < SlotCount() && handle.generation == generations[handle.index]
+            && IsLive(handle.index);
+    }
+
+    // Unchecked access by slot index; the slot must be live
+    T& At(uint32_t slot) { return values[slot]; }
+    const T& At(uint32_t slot) const { return values[slot]; }
+
+    bool IsLive(uint32_t slot) const { return TestBit(liveBits, slot); }
+    SlotHandle HandleAt(uint32_t slot) const {
+        return IsLive(slot) ? SlotHandle(slot, generations[slot]) : SlotHandle();
+    }
+
+    // One past the highest slot ever used, live or not
+    uint32_t SlotCount() const { return static_cast<uint32_t>(generations.size()); }
+
+    size_t size() const { return liveCount; }
+    bool empty() const { return liveCount == 0; }
+    void reserve(size_t count) {
+        generations.reserve(count);
+        liveBits.reserve(BitmapWords(count));
+    }
+
+    // Invalidates every outstanding handle, including those of reused slots
+    void clear() {
+        values.clear();
+        freeSlots.clear();
+        for (auto& generation : generations) {
+            if (generation & 1) ++generation;
+        }
+        freeSlots.reserve(generations.size());
+        for (uint32_t slot = SlotCount(); slot-- > 0;) freeSlots.push_back(slot);
+        values.resize(generations.size());
+        std::fill(liveBits.begin(), liveBits.end(), 0);
+        liveCount = 0;
+    }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, SlotCount()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, SlotCount()); }
+
+private:
+    std::deque<T> values;
+    std::vector<uint32_t> generations;
+    std::vector<uint32_t> freeSlots;   // Popped from the back
+    std::vector<uint64_t> liveBits;
+    size_t liveCount = 0;
+};
+
+// Slot map of records (Expense, Income) with a hash index on their id string.
+// Records without an id are stored but cannot be looked up; when ids collide
+// the most recently inserted record wins until RebuildIdIndex().
+// Code that changes a stored record's id must call RebuildIdIndex().
+template <typename T>
+class RecordStore {
+public:
+    using iterator = typename SlotMap<T>::iterator;
+    using const_iterator = typename SlotMap<T>::const_iterator;
+
+    SlotHandle Insert(T record) {
+        SlotHandle handle = records.Insert(std::move(record));
+        const auto& id = records.At(handle.index).id;
+        if (!id.empty()) idIndex.insert_or_assign(std::wstring(id), handle.index);
+        return handle;
+    }
+
+    bool Erase(SlotHandle handle) {
+        if (!records.Contains(handle)) return false;
+        EraseSlot(handle.index);
+        return true;
+    }
+
+    void EraseSlot(uint32_t slot) {
+        auto it = idIndex.find(std::wstring_view(records.At(slot).id));
+        if (it != idIndex.end() && it->second == slot) idIndex.erase(it);
+        records.EraseSlot(slot);
+    }
+
+    // Replaces the record at a live slot. The new record keeps its own memory
+    // resource, so editing a loaded record does not grow the load's arena.
+    void Replace(uint32_t slot, T record) {
+        auto it = idIndex.find(std::wstring_view(records.At(slot).id));
+        if (it != idIndex.end() && it->second == slot) idIndex.erase(it);
+        records.Replace(slot, std::move(record));
+        const auto& id = records.At(slot).id;
+        if (!id.empty()) idIndex.insert_or_assign(std::wstring(id), slot);
+    }
+
+    // Null handle when no record has this id
+    SlotHandle Find(std::wstring_view id) const {
+        auto it = idIndex.find(id);
+        return it != idIndex.end() ? records.HandleAt(it->second) : SlotHandle();
+    }
+
+    T* FindRecord(std::wstring_view id) { return records.Get(Find(id)); }
+    const T* FindRecord(std::wstring_view id) const { return records.Get(Find(id)); }
+
+    // Slots of every record matching pred, for bulk removal: hand them to the
+    // ledger first, then to EraseSlots()
+    template <typename Pred>
+    std::vector<uint32_t> FindSlots(Pred pred) const {
+        std::vector<uint32_t> slots;
+        for (auto it = records.begin(); it != records.end(); ++it) {
+            if (pred(*it)) slots.push_back(it.Slot());
+        }
+        return slots;
+    }
+
+    void EraseSlots(std::span<const uint32_t> slots) {
+        for (uint32_t slot : slots) EraseSlot(slot);
+    }
+
+    void RebuildIdIndex() {
+        idIndex.clear();
+        for (auto it = records.begin(); it != records.end(); ++it) {
+            if (!it->id.empty()) idIndex.insert_or_assign(std::wstring(it->id), it.Slot());
+        }
+    }
+
+    T* Get(SlotHandle handle) { return records.Get(handle); }
+    const T* Get(SlotHandle handle) const { return records.Get(handle); }
+    bool Contains(SlotHandle handle) const { return records.Contains(handle); }
+
+    T& At(uint32_t slot) { return records.At(slot); }
+    const T& At(uint32_t slot) const { return records.At(slot); }
+    bool IsLive(uint32_t slot) const { return records.IsLive(slot); }
+    SlotHandle HandleAt(uint32_t slot) const { return records.HandleAt(slot); }
+    uint32_t SlotCount() const { return records.SlotCount(); }
+
+    size_t size() const { return records.size(); }
+    bool empty() const { return records.empty(); }
+
+    void reserve(size_t count) {
+        records.reserve(count);
+        idIndex.reserve(count);
+    }
+
+    void clear() {
+        records.clear();
+        idIndex.clear();
+    }
+
+    iterator begin() { return records.begin(); }
+    iterator end() { return records.end(); }
+    const_iterator begin() const { return records.begin(); }
+    const_iterator end() const { return records.end(); }
+
+private:
+    // Transparent, so ids of any string type are looked up without a copy
+    struct IdHash {
+        using is_transparent = void;
+        size_t operator()(std::wstring_view id) const { return std::hash<std::wstring_view>()(id); }
+    };
+
+    SlotMap<T> records;
+    std::unordered_map<std::wstring, uint32_t, IdHash, std::equal_to<>> idIndex;
+};
+
+// Read-only view of the records at a list of slots, e.g. a postings list.
+// Holds no copies; valid as long as the slot list and the records are.
+template <typename T>
+class RecordView {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        Iterator() : store(nullptr), slot(nullptr) {}
+        Iterator(const RecordStore<T>* s, const uint32_t* p) : store(s), slot(p) {}
+
+        reference operator*() const { return store->At(*slot); }
+        pointer operator->() const { return &store->At(*slot); }
+        Iterator& operator++() { ++slot; return *this; }
+        Iterator operator++(int) { Iterator old = *this; ++slot; return old; }
+        bool operator==(const Iterator& other) const { return slot == other.slot; }
+
+    private:
+        const RecordStore<T>* store;
+        const uint32_t* slot;
+    };
+
+    using iterator = Iterator;
+    using const_iterator = Iterator;
+
+    RecordView(const RecordStore<T>& source, std::span<const uint32_t> slotList)
+        : store(&source), slots(slotList) {}
+
+    Iterator begin() const { return Iterator(store, slots.data()); }
+    Iterator end() const { return Iterator(store, slots.data() + slots.size()); }
+    size_t size() const { return slots.size(); }
+    bool empty() const { return slots.empty(); }
+    const T& operator[](size_t i) const { return store->At(slots[i]); }
+
+    std::span<const uint32_t> Slots() const { return slots; }
+
+private:
+    const RecordStore<T>* store;
+    std::span<const uint32_t> slots;
+};
@@ -0,0 +1,156 @@
+#include "SortIndex.h"
+#include <algorithm>
+
+SortIndex sortIndex;
+
+static const RecordString& NoteOf(size_t row) {
+    LedgerRow record = ledger.Row(row);
+    return record.IsIncome() ? record.GetIncome().note : record.GetExpense().note;
+}
+
+// <0, 0 or >0 as row a's key sorts before, with or after row b's
+static int CompareKeys(SortColumn column, size_t a, size_t b) {
+    switch (column) {
+    case SortColumn::Date: {
+        int32_t dayA = ledger.Days()[a];
+        int32_t dayB = ledger.Days()[b];
+        return dayA < dayB ? -1 : dayA > dayB;
+    }
+    case SortColumn::Amount: {
+        double amountA = ledger.Amounts()[a];
+        double amountB = ledger.Amounts()[b];
+        return amountA < amountB ? -1 : amountA > amountB;
+    }
+    case SortColumn::Category: {
+        SymbolId categoryA = ledger.Categories()[a];
+        SymbolId categoryB = ledger.Categories()[b];
+        if (categoryA == categoryB) return 0;
+        return SymbolTable::Resolve(categoryA).compare(SymbolTable::Resolve(categoryB));
+    }
+    case SortColumn::Note:
+        return NoteOf(a).compare(NoteOf(b));
+    }
+    return 0;
+}
+
+static bool RowBefore(SortColumn column, size_t a, size_t b) {
+    int order = CompareKeys(column, a, b);
+    return order != 0 ? order < 0 : ledger.Sequences()[a] < ledger.Sequences()[b];
+}
+
+static void InsertRow(std::vector<uint32_t>& rows, SortColumn column, size_t row) {
+    auto it = std::upper_bound(rows.begin(), rows.end(), row,
+        [column](size_t a, uint32_t b) { return RowBefore(column, a, b); });
+    rows.insert(it, static_cast<uint32_t>(row));
+}
+
+static std::vector<uint32_t>::iterator FindRow(std::vector<uint32_t>& rows, SortColumn column, size_t row) {
+    auto it = std::lower_bound(rows.begin(), rows.end(), row,
+        [column](uint32_t a, size_t b) { return RowBefore(column, a, b); });
+    if (it != rows.end() && *it == row) return it;
+
+    // An edited note is already in the record when the update arrives, so the
+    // row may not be where its key says
+    return std::find(rows.begin(), rows.end(), static_cast<uint32_t>(row));
+}
+
+std::vector<uint32_t> SortIndex::Order(SymbolId user, const SortKey& primary, const SortKey& secondary) const {
+    std::span<const uint32_t> first = Rows(user, primary.column);
+    std::vector<uint32_t> order(first.begin(), first.end());
+    if (primary.descending) std::reverse(order.begin(), order.end());
+    if (secondary.column == primary.column || order.size() < 2) return order;
+
+    // Number the runs of equal primary keys, then deal the rows out in
+    // secondary order, each into the next free place of its run: a stable
+    // counting sort that compares no keys
+    std::vector<uint32_t> runOf(ledger.Size());
+    std::vector<size_t> runStart;
+    for (size_t i = 0; i < order.size(); ++i) {
+        if (i == 0 || CompareKeys(primary.column, order[i - 1], order[i]) != 0) runStart.push_back(i);
+        runOf[order[i]] = static_cast<uint32_t>(runStart.size() - 1);
+    }
+    if (runStart.size() == order.size()) return order;   // No ties to break
+
+    auto deal = [&](uint32_t row) { order[runStart[runOf[row]]++] = row; };
+    std::span<const uint32_t> second = Rows(user, secondary.column);
+    if (secondary.descending) std::for_each(second.rbegin(), second.rend(), deal);
+    else std::for_each(second.begin(), second.end(), deal);
+    return order;
+}
+
+std::span<const uint32_t> SortIndex::Rows(SymbolId user, SortColumn column) const {
+    auto it = scopes.find(user);
+    if (it == scopes.end()) return {};
+    return it->second.byColumn[static_cast<size_t>(column)];
+}
+
+template <typename Fn>
+void SortIndex::ForEachScope(size_t row, Fn fn) {
+    fn(scopes[ALL_SYMBOLS]);
+    fn(scopes[ledger.Users()[row]]);
+}
+
+void SortIndex::OnRebuilt() {
+    OnCleared();
+    ledger.ForEachRow([this](size_t row) {
+        ForEachScope(row, [row](Permutations& scope) {
+            for (auto& rows : scope.byColumn) rows.push_back(static_cast<uint32_t>(row));
+        });
+    });
+    for (auto& pair : scopes) {
+        for (size_t column = 0; column < SORT_COLUMN_COUNT; ++column) {
+            auto& rows = pair.second.byColumn[column];
+            std::sort(rows.begin(), rows.end(), [column](uint32_t a, uint32_t b) {
+                return RowBefore(static_cast<SortColumn>(column), a, b);
+            });
+        }
+    }
+}
+
+void SortIndex::OnCleared() {
+    scopes.clear();
+}
+
+void SortIndex::OnRowAdded(size_t row) {
+    ForEachScope(row, [row](Permutations& scope) {
+        for (size_t column = 0; column < SORT_COLUMN_COUNT; ++column) {
+            InsertRow(scope.byColumn[column], static_cast<SortColumn>(column), row);
+        }
+    });
+}
+
+void SortIndex::OnRowRemoving(size_t row) {
+    ForEachScope(row, [row](Permutations& scope) {
+        for (size_t column = 0; column < SORT_COLUMN_COUNT; ++column) {
+            auto& rows = scope.byColumn[column];
+            auto it = FindRow(rows, static_cast<SortColumn>(column), row);
+            if (it != rows.end()) rows.erase(it);
+        }
+    });
+}
+
+void SortIndex::OnRowsRemoved(std::span<const uint32_t> rows) {
+    // Each scope that lost rows gets one pass per column
+    std::vector<Permutations*> touched;
+    for (uint32_t row : rows) {
+        ForEachScope(row, [&touched](Permutations& scope) {
+            if (std::find(touched.begin(), touched.end(), &scope) == touched.end()) touched.push_back(&scope);
+        });
+    }
+    for (auto* scope : touched) {
+        for (auto& list : scope->byColumn) {
+            list.erase(std::remove_if(list.begin(), list.end(),
+                [](uint32_t row) { return !ledger.IsLive(row); }), list.end());
+        }
+    }
+}
+
+void SortIndex::OnRowMoved(size_t from, size_t to) {
+    ForEachScope(from, [from, to](Permutations& scope) {
+        for (size_t column = 0; column < SORT_COLUMN_COUNT; ++column) {
+            auto& rows = scope.byColumn[column];
+            auto it = FindRow(rows, static_cast<SortColumn>(column), from);
+            if (it != rows.end()) *it = static_cast<uint32_t>(to);
+        }
+    });
+}
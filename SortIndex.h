@@ -0,0 +1,55 @@
+#pragma once
+#include "Ledger.h"
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+// Columns the transaction list can be sorted on
+enum class SortColumn {
+    Date,
+    Amount,
+    Category,   // By name; source for incomes
+    Note
+};
+
+const size_t SORT_COLUMN_COUNT = 4;
+
+struct SortKey {
+    SortColumn column = SortColumn::Date;
+    bool descending = true;
+};
+
+// Cached sort permutations: for every user, and for all users together, the
+// ledger rows of both kinds in each column's order (ties by sequence). They
+// are kept up to date row by row, so sorting a listing is a walk over a
+// permutation rather than a sort of record copies.
+class SortIndex : public LedgerIndex {
+public:
+    // Rows in primary order; rows with equal primary keys in secondary order.
+    // Pass ALL_SYMBOLS for every user. Row numbers are valid until the next
+    // ledger change.
+    std::vector<uint32_t> Order(SymbolId user, const SortKey& primary, const SortKey& secondary) const;
+
+    // One column's permutation, ascending
+    std::span<const uint32_t> Rows(SymbolId user, SortColumn column) const;
+
+    void OnRebuilt() override;
+    void OnCleared() override;
+    void OnRowAdded(size_t row) override;
+    void OnRowRemoving(size_t row) override;
+    void OnRowsRemoved(std::span<const uint32_t> rows) override;
+    void OnRowMoved(size_t from, size_t to) override;
+
+private:
+    struct Permutations {
+        std::vector<uint32_t> byColumn[SORT_COLUMN_COUNT];
+    };
+
+    // The two scopes a row belongs to
+    template <typename Fn>
+    void ForEachScope(size_t row, Fn fn);
+
+    std::unordered_map<SymbolId, Permutations> scopes;   // By user, ALL_SYMBOLS for everyone
+};
+
+extern SortIndex sortIndex;
@@ -3,6 +3,7 @@
 #include "Utils.h"
 #include "resource.h"  
 #include "UserManager.h"
+#include "Ledger.h"
 // For resource IDs
 #include <sstream>     // For 'ss', 'stream'
 #include <iostream>    // For 'std::cout', 'out'
@@ -87,7 +88,8 @@ LRESULT CALLBACK ExpenseDialogProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM l
             newExpense.note = note;
             newExpense.date = GetCurrentDate();
 
-            expenses.push_back(newExpense);
+            InternSymbols(newExpense);
+            ledger.AddExpense(expenses.Insert(newExpense).index);
 
             MessageBox(hwnd, L"Expense added successfully!", L"Success", MB_OK);
             DestroyWindow(hwnd);
@@ -137,7 +139,8 @@ LRESULT CALLBACK IncomeDialogProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lP
             newIncome.note = note;
             newIncome.date = GetCurrentDate();
 
-            incomes.push_back(newIncome);
+            InternSymbols(newIncome);
+            ledger.AddIncome(incomes.Insert(newIncome).index);
 
             MessageBox(hwnd, L"Income added successfully!", L"Success", MB_OK);
             DestroyWindow(hwnd);
@@ -269,9 +272,9 @@ void ShowExpensesDialog(HWND hwnd) {
         ss << L"No expenses recorded.\n";
     }
     else {
-        for (size_t i = 0; i < expenses.size(); i++) {
-            const auto& exp = expenses[i];
-            ss << L"#" << (i + 1) << L" - " << exp.date << L"\n";
+        size_t i = 0;
+        for (const auto& exp : expenses) {
+            ss << L"#" << ++i << L" - " << exp.date << L"\n";
             ss << L"Category: " << exp.category << L"\n";
             ss << L"Amount: $" << std::fixed << std::setprecision(2) << exp.amount << L"\n";
             if (!exp.note.empty()) {
@@ -294,9 +297,9 @@ void ShowIncomeDialog(HWND hwnd) {
         ss << L"No income recorded.\n";
     }
     else {
-        for (size_t i = 0; i < incomes.size(); i++) {
-            const auto& inc = incomes[i];
-            ss << L"#" << (i + 1) << L" - " << inc.date << L"\n";
+        size_t i = 0;
+        for (const auto& inc : incomes) {
+            ss << L"#" << ++i << L" - " << inc.date << L"\n";
             ss << L"Source: " << inc.source << L"\n";
             ss << L"Amount: $" << std::fixed << std::setprecision(2) << inc.amount << L"\n";
             if (!inc.note.empty()) {
@@ -361,6 +364,8 @@ void LoadDataFromFile() {
 
     expenses.clear();
     incomes.clear();
+    ResetRecordArena();
+    ledger.Clear();
 
     std::wstring line;
     bool readingExpenses = false;
@@ -392,7 +397,7 @@ void LoadDataFromFile() {
             std::wstring note = line.substr(pos3 + 1);
 
             if (readingExpenses) {
-                Expense newExpense;
+                Expense newExpense(RecordArena());
                 newExpense.id = L"EXP_" + std::to_wstring(GetNextExpenseId());  // Generate unique ID
                 newExpense.userId = UserManager::currentUsername;  // Use current username (wstring)
                 newExpense.amount = amount;
@@ -401,10 +406,11 @@ void LoadDataFromFile() {
                 newExpense.date = date;
                 newExpense.currency = CurrencyType::USD;  // Set default values
                 newExpense.exchangeRate = 1.0;
-                expenses.push_back(newExpense);
+                InternSymbols(newExpense);
+                ledger.AddExpense(expenses.Insert(std::move(newExpense)).index);
             }
             else if (readingIncome) {
-                Income newIncome;
+                Income newIncome(RecordArena());
                 newIncome.id = L"INC_" + std::to_wstring(GetNextIncomeId());  // Generate unique ID
                 newIncome.userId = UserManager::currentUsername;  // Use current username (wstring)
                 newIncome.amount = amount;
@@ -414,7 +420,8 @@ void LoadDataFromFile() {
                 newIncome.currency = CurrencyType::USD;  // Set default values
                 newIncome.exchangeRate = 1.0;
                 newIncome.isTaxable = true;
-                incomes.push_back(newIncome);
+                InternSymbols(newIncome);
+                ledger.AddIncome(incomes.Insert(std::move(newIncome)).index);
             }
         }
     }
@@ -0,0 +1,226 @@
+#include "StatsKernels.h"
+#include <algorithm>
+#include <cmath>
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#include <emmintrin.h>
+#define STATS_SSE2 1
+#endif
+
+#ifdef STATS_SSE2
+static double HorizontalSum(__m128d lanes) {
+    return _mm_cvtsd_f64(_mm_add_sd(lanes, _mm_unpackhi_pd(lanes, lanes)));
+}
+#endif
+
+// Sum of (value - mean)^2, the second pass of the variance
+static double SquaredDeviations(std::span<const double> values, double mean) {
+    size_t count = values.size();
+    size_t i = 0;
+    double total = 0.0;
+
+#ifdef STATS_SSE2
+    __m128d center = _mm_set1_pd(mean);
+    __m128d sumA = _mm_setzero_pd();
+    __m128d sumB = _mm_setzero_pd();
+    for (; i + 4 <= count; i += 4) {
+        __m128d a = _mm_sub_pd(_mm_loadu_pd(&values[i]), center);
+        __m128d b = _mm_sub_pd(_mm_loadu_pd(&values[i + 2]), center);
+        sumA = _mm_add_pd(sumA, _mm_mul_pd(a, a));
+        sumB = _mm_add_pd(sumB, _mm_mul_pd(b, b));
+    }
+    total = HorizontalSum(_mm_add_pd(sumA, sumB));
+#endif
+    for (; i < count; ++i) {
+        double diff = values[i] - mean;
+        total += diff * diff;
+    }
+    return total;
+}
+
+// Centered co-moments of two equal-length columns: sum dx*dy, dx^2 and dy^2
+struct CoMoments {
+    double xy = 0.0;
+    double xx = 0.0;
+    double yy = 0.0;
+};
+
+static CoMoments CenteredCoMoments(std::span<const double> x, std::span<const double> y, double meanX, double meanY) {
+    size_t count = std::min(x.size(), y.size());
+    size_t i = 0;
+    CoMoments moments;
+
+#ifdef STATS_SSE2
+    __m128d centerX = _mm_set1_pd(meanX);
+    __m128d centerY = _mm_set1_pd(meanY);
+    __m128d sumXY = _mm_setzero_pd();
+    __m128d sumXX = _mm_setzero_pd();
+    __m128d sumYY = _mm_setzero_pd();
+    for (; i + 2 <= count; i += 2) {
+        __m128d dx = _mm_sub_pd(_mm_loadu_pd(&x[i]), centerX);
+        __m128d dy = _mm_sub_pd(_mm_loadu_pd(&y[i]), centerY);
+        sumXY = _mm_add_pd(sumXY, _mm_mul_pd(dx, dy));
+        sumXX = _mm_add_pd(sumXX, _mm_mul_pd(dx, dx));
+        sumYY = _mm_add_pd(sumYY, _mm_mul_pd(dy, dy));
+    }
+    moments.xy = HorizontalSum(sumXY);
+    moments.xx = HorizontalSum(sumXX);
+    moments.yy = HorizontalSum(sumYY);
+#endif
+    for (; i < count; ++i) {
+        double dx = x[i] - meanX;
+        double dy = y[i] - meanY;
+        moments.xy += dx * dy;
+        moments.xx += dx * dx;
+        moments.yy += dy * dy;
+    }
+    return moments;
+}
+
+double StatsKernels::Sum(std::span<const double> values) {
+    size_t count = values.size();
+    size_t i = 0;
+    double total = 0.0;
+
+#ifdef STATS_SSE2
+    // Two accumulators of two lanes each, so consecutive adds do not wait on each other
+    __m128d sumA = _mm_setzero_pd();
+    __m128d sumB = _mm_setzero_pd();
+    for (; i + 4 <= count; i += 4) {
+        sumA = _mm_add_pd(sumA, _mm_loadu_pd(&values[i]));
+        sumB = _mm_add_pd(sumB, _mm_loadu_pd(&values[i + 2]));
+    }
+    total = HorizontalSum(_mm_add_pd(sumA, sumB));
+#endif
+    for (; i < count; ++i) {
+        total += values[i];
+    }
+    return total;
+}
+
+double StatsKernels::Mean(std::span<const double> values) {
+    return values.empty() ? 0.0 : Sum(values) / values.size();
+}
+
+double StatsKernels::Variance(std::span<const double> values) {
+    if (values.size() < 2) return 0.0;
+
+    // Two passes: squaring deviations from the mean stays accurate where the
+    // sum-of-squares shortcut cancels
+    return SquaredDeviations(values, Mean(values)) / (values.size() - 1);
+}
+
+double StatsKernels::StandardDeviation(std::span<const double> values) {
+    return std::sqrt(Variance(values));
+}
+
+double StatsKernels::Covariance(std::span<const double> x, std::span<const double> y) {
+    size_t count = std::min(x.size(), y.size());
+    if (count < 2) return 0.0;
+
+    x = x.first(count);
+    y = y.first(count);
+    return CenteredCoMoments(x, y, Mean(x), Mean(y)).xy / (count - 1);
+}
+
+double StatsKernels::Correlation(std::span<const double> x, std::span<const double> y) {
+    size_t count = std::min(x.size(), y.size());
+    if (count < 2) return 0.0;
+
+    x = x.first(count);
+    y = y.first(count);
+    CoMoments moments = CenteredCoMoments(x, y, Mean(x), Mean(y));
+    if (moments.xx <= 0.0 || moments.yy <= 0.0) return 0.0;
+    return moments.xy / std::sqrt(moments.xx * moments.yy);
+}
+
+double StatsKernels::Median(std::span<double> values) {
+    if (values.empty()) return 0.0;
+
+    // Upper middle by selection; for an even count the lower middle is then
+    // the largest value left of it
+    size_t middle = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + middle, values.end());
+    double upper = values[middle];
+    if (values.size() % 2 != 0) return upper;
+
+    double lower = *std::max_element(values.begin(), values.begin() + middle);
+    return (lower + upper) / 2.0;
+}
+
+void StatsKernels::MovingAverage(std::span<const double> values, size_t window, std::span<double> averages) {
+    if (window == 0 || values.size() < window) return;
+
+    size_t count = std::min(values.size() - window + 1, averages.size());
+    if (count == 0) return;
+
+    double sum = Sum(values.first(window));
+    averages[0] = sum / window;
+    for (size_t i = 1; i < count; ++i) {
+        sum += values[i + window - 1] - values[i - 1];
+        averages[i] = sum / window;
+    }
+}
+
+LineFit StatsKernels::FitLine(std::span<const double> x, std::span<const double> y) {
+    LineFit fit;
+    size_t count = std::min(x.size(), y.size());
+    if (count < 2) return fit;
+
+    // Sums are taken relative to the first point, which keeps the
+    // single-pass formulas from cancelling on large, tightly spread values
+    // such as day numbers or balances
+    double originX = x[0];
+    double originY = y[0];
+    size_t i = 0;
+    double sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumXY = 0.0, sumYY = 0.0;
+
+#ifdef STATS_SSE2
+    __m128d shiftX = _mm_set1_pd(originX);
+    __m128d shiftY = _mm_set1_pd(originY);
+    // Four points per step: the second half uses its own x and xy lanes so
+    // the longest add chains are split in two
+    __m128d laneX = _mm_setzero_pd(), laneX2 = _mm_setzero_pd();
+    __m128d laneY = _mm_setzero_pd();
+    __m128d laneXX = _mm_setzero_pd();
+    __m128d laneXY = _mm_setzero_pd(), laneXY2 = _mm_setzero_pd();
+    __m128d laneYY = _mm_setzero_pd();
+    for (; i + 4 <= count; i += 4) {
+        __m128d dx = _mm_sub_pd(_mm_loadu_pd(&x[i]), shiftX);
+        __m128d dy = _mm_sub_pd(_mm_loadu_pd(&y[i]), shiftY);
+        __m128d dx2 = _mm_sub_pd(_mm_loadu_pd(&x[i + 2]), shiftX);
+        __m128d dy2 = _mm_sub_pd(_mm_loadu_pd(&y[i + 2]), shiftY);
+        laneX = _mm_add_pd(laneX, dx);
+        laneX2 = _mm_add_pd(laneX2, dx2);
+        laneY = _mm_add_pd(laneY, _mm_add_pd(dy, dy2));
+        laneXX = _mm_add_pd(laneXX, _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dx2, dx2)));
+        laneXY = _mm_add_pd(laneXY, _mm_mul_pd(dx, dy));
+        laneXY2 = _mm_add_pd(laneXY2, _mm_mul_pd(dx2, dy2));
+        laneYY = _mm_add_pd(laneYY, _mm_add_pd(_mm_mul_pd(dy, dy), _mm_mul_pd(dy2, dy2)));
+    }
+    sumX = HorizontalSum(_mm_add_pd(laneX, laneX2));
+    sumY = HorizontalSum(laneY);
+    sumXX = HorizontalSum(laneXX);
+    sumXY = HorizontalSum(_mm_add_pd(laneXY, laneXY2));
+    sumYY = HorizontalSum(laneYY);
+#endif
+    for (; i < count; ++i) {
+        double dx = x[i] - originX;
+        double dy = y[i] - originY;
+        sumX += dx;
+        sumY += dy;
+        sumXX += dx * dx;
+        sumXY += dx * dy;
+        sumYY += dy * dy;
+    }
+
+    double n = static_cast<double>(count);
+    double spreadX = n * sumXX - sumX * sumX;
+    double spreadY = n * sumYY - sumY * sumY;
+    double coSpread = n * sumXY - sumX * sumY;
+    if (spreadX <= 0.0) return fit;
+
+    fit.slope = coSpread / spreadX;
+    fit.intercept = originY + (sumY - fit.slope * sumX) / n - fit.slope * originX;
+    fit.rSquared = spreadY > 0.0 ? std::min(1.0, coSpread * coSpread / (spreadX * spreadY)) : 1.0;
+    return fit;
+}
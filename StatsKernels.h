@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <span>
+
+// Least-squares line y = slope * x + intercept
+struct LineFit {
+    double slope = 0.0;
+    double intercept = 0.0;
+    double rSquared = 0.0;   // 1 when y is constant, 0 when x is
+};
+
+// Statistics over contiguous columns of doubles. Sums and moments run two
+// lanes per SSE2 step into independent accumulators; medians and moving
+// averages avoid sorting and rescanning. Paired columns of different lengths
+// are truncated to the shorter one.
+class StatsKernels {
+public:
+    static double Sum(std::span<const double> values);
+    static double Mean(std::span<const double> values);
+
+    // Sample statistics (n - 1); 0 for fewer than two values
+    static double Variance(std::span<const double> values);
+    static double StandardDeviation(std::span<const double> values);
+    static double Covariance(std::span<const double> x, std::span<const double> y);
+
+    // Pearson coefficient; 0 when either column is constant
+    static double Correlation(std::span<const double> x, std::span<const double> y);
+
+    // Selects the middle value(s) in place with nth_element, reordering values
+    static double Median(std::span<double> values);
+
+    // Mean of every window consecutive values, values.size() - window + 1 of
+    // them, sliding one add and one subtract per step
+    static void MovingAverage(std::span<const double> values, size_t window, std::span<double> averages);
+
+    // All sums gathered in one pass over both columns
+    static LineFit FitLine(std::span<const double> x, std::span<const double> y);
+};
@@ -0,0 +1,95 @@
+#include "SymbolTable.h"
+#include "DataStructures.h"
+#include "Utils.h"
+
+std::deque<std::wstring> SymbolTable::strings;
+std::unordered_map<std::wstring_view, SymbolId> SymbolTable::lookup;
+std::deque<std::string> SymbolTable::utf8Strings;
+std::unordered_map<std::string_view, SymbolId> SymbolTable::utf8Lookup;
+
+SymbolId SymbolTable::Intern(std::wstring_view text) {
+    if (strings.empty()) {
+        // Reserve id 0 for the empty string so default-constructed records match it
+        strings.emplace_back();
+        lookup.emplace(std::wstring_view(strings.back()), EMPTY_SYMBOL);
+        utf8Strings.emplace_back();
+        utf8Lookup.emplace(std::string_view(utf8Strings.back()), EMPTY_SYMBOL);
+    }
+
+    auto it = lookup.find(text);
+    if (it != lookup.end()) {
+        return it->second;
+    }
+
+    SymbolId id = static_cast<SymbolId>(strings.size());
+    strings.emplace_back(text);
+    lookup.emplace(std::wstring_view(strings.back()), id);
+
+    utf8Strings.push_back(WStringToString(strings.back()));
+    utf8Lookup.emplace(std::string_view(utf8Strings.back()), id);
+    return id;
+}
+
+SymbolId SymbolTable::Find(std::wstring_view text) {
+    if (text.empty()) return EMPTY_SYMBOL;
+
+    auto it = lookup.find(text);
+    return (it != lookup.end()) ? it->second : INVALID_SYMBOL;
+}
+
+std::wstring_view SymbolTable::Resolve(SymbolId id) {
+    if (id >= strings.size()) return std::wstring_view();
+    return strings[id];
+}
+
+SymbolId SymbolTable::InternUtf8(std::string_view text) {
+    auto it = utf8Lookup.find(text);
+    if (it != utf8Lookup.end()) {
+        return it->second;
+    }
+
+    // Not seen in this encoding yet. Malformed input can decode to an existing
+    // wide string, in which case that symbol is reused without a UTF-8 alias.
+    return Intern(StringToWString(std::string(text)));
+}
+
+std::string_view SymbolTable::ResolveUtf8(SymbolId id) {
+    if (id >= utf8Strings.size()) return std::string_view();
+    return utf8Strings[id];
+}
+
+size_t SymbolTable::Size() {
+    return strings.size();
+}
+
+void InternSymbols(Expense& expense) {
+    expense.userSymbol = SymbolTable::Intern(expense.userId);
+    expense.categorySymbol = SymbolTable::Intern(expense.category);
+
+    expense.tagSymbols.clear();
+    for (const auto& tag : expense.tags) {
+        expense.tagSymbols.push_back(SymbolTable::Intern(tag));
+    }
+}
+
+void InternSymbols(Income& income) {
+    income.userSymbol = SymbolTable::Intern(income.userId);
+    income.sourceSymbol = SymbolTable::Intern(income.source);
+
+    income.tagSymbols.clear();
+    for (const auto& tag : income.tags) {
+        income.tagSymbols.push_back(SymbolTable::Intern(tag));
+    }
+}
+
+std::vector<SymbolId> FindSymbols(const std::vector<std::wstring>& values) {
+    std::vector<SymbolId> ids;
+    ids.reserve(values.size());
+    for (const auto& value : values) {
+        SymbolId id = SymbolTable::Find(value);
+        if (id != INVALID_SYMBOL) {
+            ids.push_back(id);
+        }
+    }
+    return ids;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct Expense;
+struct Income;
+
+// Interned string id. Records keep their display strings, but filters and
+// aggregations compare these ids instead of std::wstring.
+using SymbolId = uint32_t;
+
+const SymbolId EMPTY_SYMBOL = 0;              // Always the empty string
+const SymbolId INVALID_SYMBOL = 0xFFFFFFFF;   // Returned by Find for unknown strings
+const SymbolId ALL_SYMBOLS = INVALID_SYMBOL;  // Index scope wildcard: every user / every category
+
+class SymbolTable {
+public:
+    // Returns the id for text, adding it to the table on first use
+    static SymbolId Intern(std::wstring_view text);
+
+    // Returns the id for text without adding it, or INVALID_SYMBOL
+    static SymbolId Find(std::wstring_view text);
+
+    // Reverse lookup for display. The returned view is null-terminated and
+    // stays valid for the lifetime of the table.
+    static std::wstring_view Resolve(SymbolId id);
+
+    // UTF-8 side used by persistence. Each symbol is converted once when it is
+    // interned, so saving and loading repeated values skips the conversion.
+    static SymbolId InternUtf8(std::string_view text);
+    static std::string_view ResolveUtf8(SymbolId id);
+
+    static size_t Size();
+
+private:
+    static std::deque<std::wstring> strings;   // deque keeps views stable on growth
+    static std::unordered_map<std::wstring_view, SymbolId> lookup;
+
+    static std::deque<std::string> utf8Strings;   // Parallel to strings
+    static std::unordered_map<std::string_view, SymbolId> utf8Lookup;
+};
+
+// Refresh the interned ids of a record from its string fields.
+// Must be called whenever a record enters the global containers or is edited.
+void InternSymbols(Expense& expense);
+void InternSymbols(Income& income);
+
+// Maps filter values to ids, dropping values that were never interned
+// (no record can match those).
+std::vector<SymbolId> FindSymbols(const std::vector<std::wstring>& values);
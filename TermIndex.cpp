@@ -0,0 +1,260 @@
+#include "TermIndex.h"
+#include "TextIndex.h"
+#include <algorithm>
+#include <cwctype>
+
+TermIndex termIndex;
+
+std::vector<std::wstring> SplitWords(std::wstring_view text) {
+    std::vector<std::wstring> words;
+    std::wstring word;
+    for (wchar_t ch : text) {
+        if (std::iswalnum(ch)) {
+            word += static_cast<wchar_t>(std::towlower(ch));
+        }
+        else if (!word.empty()) {
+            words.push_back(std::move(word));
+            word.clear();
+        }
+    }
+    if (!word.empty()) words.push_back(std::move(word));
+    return words;
+}
+
+uint32_t MaxEditDistance(size_t length) {
+    if (length <= 3) return 0;
+    if (length <= 5) return 1;
+    return 2;
+}
+
+std::vector<FuzzyMatch> TermIndex::FindFuzzy(const std::wstring& query) const {
+    std::vector<FuzzyMatch> matches;
+    std::vector<std::wstring> words = SplitWords(query);
+    if (words.empty()) return matches;
+
+    // Best distance per row for the words so far; rows missing a word drop out
+    std::unordered_map<uint32_t, uint32_t> best;
+    for (size_t w = 0; w < words.size(); ++w) {
+        std::unordered_map<uint32_t, uint32_t> found;
+        for (const auto& similar : Similar(words[w], MaxEditDistance(words[w].size()))) {
+            // Closest terms come first, so the first distance seen for a row is its best
+            termRows[similar.term].ForEach([&](uint32_t row) {
+                if (w > 0 && !best.contains(row)) return;
+                found.try_emplace(row, similar.distance);
+            });
+        }
+
+        if (w > 0) {
+            for (auto& [row, distance] : found) distance += best[row];
+        }
+        best = std::move(found);
+        if (best.empty()) return matches;
+    }
+
+    matches.reserve(best.size());
+    for (const auto& [row, distance] : best) matches.push_back({ row, distance });
+
+    // Closest first, then newest
+    auto dayColumn = ledger.Days();
+    auto seqColumn = ledger.Sequences();
+    std::sort(matches.begin(), matches.end(), [&](const FuzzyMatch& a, const FuzzyMatch& b) {
+        if (a.distance != b.distance) return a.distance < b.distance;
+        if (dayColumn[a.row] != dayColumn[b.row]) return dayColumn[a.row] > dayColumn[b.row];
+        return seqColumn[a.row] > seqColumn[b.row];
+    });
+    return matches;
+}
+
+std::vector<std::wstring> TermIndex::SimilarTerms(std::wstring_view word, uint32_t maxDistance, size_t limit) const {
+    std::vector<std::wstring> result;
+    std::wstring folded = FoldText(word);
+    for (const auto& similar : Similar(folded, maxDistance)) {
+        if (result.size() >= limit) break;
+        result.push_back(terms[similar.term]);
+    }
+    return result;
+}
+
+// Terms in use within maxDistance of word, closest first, then most used.
+// Walks the dictionary in sorted order keeping one row of the edit distance
+// matrix per character of the current term. Consecutive terms share a prefix,
+// so only the rows past it are recomputed, and once every entry of a row
+// exceeds maxDistance no term with that prefix can match and the whole run
+// of them is skipped with a binary search.
+std::vector<TermIndex::TermDistance> TermIndex::Similar(std::wstring_view word, uint32_t maxDistance) const {
+    std::vector<TermDistance> found;
+
+    if (maxDistance == 0) {
+        auto it = termIds.find(std::wstring(word));
+        if (it != termIds.end() && !termRows[it->second].Empty()) found.push_back({ it->second, 0 });
+        return found;
+    }
+
+    // rows[depth * width + j]: distance from word[0, j) to term[0, depth)
+    const size_t width = word.size() + 1;
+    std::vector<uint32_t> rows(width);
+    for (size_t j = 0; j < width; ++j) rows[j] = static_cast<uint32_t>(j);
+
+    std::wstring_view previous;
+    size_t validDepth = 0;   // Rows computed for previous[0, validDepth)
+
+    size_t i = 0;
+    while (i < sortedTerms.size()) {
+        std::wstring_view term = terms[sortedTerms[i]];
+
+        size_t depth = 0;
+        size_t shared = std::min(validDepth, term.size());
+        while (depth < shared && term[depth] == previous[depth]) ++depth;
+
+        if (rows.size() < (term.size() + 1) * width) rows.resize((term.size() + 1) * width);
+
+        bool pruned = false;
+        for (; depth < term.size(); ++depth) {
+            const uint32_t* above = &rows[depth * width];
+            uint32_t* row = &rows[(depth + 1) * width];
+
+            row[0] = static_cast<uint32_t>(depth + 1);
+            uint32_t rowMin = row[0];
+            for (size_t j = 1; j < width; ++j) {
+                uint32_t substitute = above[j - 1] + (term[depth] != word[j - 1] ? 1 : 0);
+                row[j] = std::min({ above[j] + 1, row[j - 1] + 1, substitute });
+                rowMin = std::min(rowMin, row[j]);
+            }
+
+            if (rowMin > maxDistance) {
+                pruned = true;
+                break;
+            }
+        }
+
+        previous = term;
+        if (pruned) {
+            // Skip every term starting with term[0, depth + 1)
+            std::wstring_view prefix = term.substr(0, depth + 1);
+            validDepth = depth + 1;
+            auto next = std::partition_point(sortedTerms.begin() + i, sortedTerms.end(), [&](uint32_t id) {
+                return std::wstring_view(terms[id]).substr(0, prefix.size()) == prefix;
+            });
+            i = next - sortedTerms.begin();
+            continue;
+        }
+
+        validDepth = term.size();
+        uint32_t distance = rows[term.size() * width + word.size()];
+        if (distance <= maxDistance && !termRows[sortedTerms[i]].Empty()) {
+            found.push_back({ sortedTerms[i], distance });
+        }
+        ++i;
+    }
+
+    std::sort(found.begin(), found.end(), [this](const TermDistance& a, const TermDistance& b) {
+        if (a.distance != b.distance) return a.distance < b.distance;
+        return termRows[a.term].Cardinality() > termRows[b.term].Cardinality();
+    });
+    return found;
+}
+
+void TermIndex::OnRebuilt() {
+    OnCleared();
+    rowTerms.resize(ledger.Size());
+
+    rebuilding = true;
+    ledger.ForEachRow([this](size_t row) { OnRowAdded(row); });
+    rebuilding = false;
+
+    sortedTerms.resize(terms.size());
+    for (uint32_t id = 0; id < sortedTerms.size(); ++id) sortedTerms[id] = id;
+    std::sort(sortedTerms.begin(), sortedTerms.end(),
+        [this](uint32_t a, uint32_t b) { return terms[a] < terms[b]; });
+}
+
+void TermIndex::OnCleared() {
+    terms.clear();
+    termRows.clear();
+    termIds.clear();
+    sortedTerms.clear();
+    rowTerms.clear();
+}
+
+void TermIndex::OnRowAdded(size_t row) {
+    if (rowTerms.size() <= row) rowTerms.resize(row + 1);
+
+    std::vector<uint32_t> ids;
+    for (const auto& term : RowTerms(row)) ids.push_back(Intern(term));
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    rowTerms[row] = std::move(ids);
+    AddPostings(static_cast<uint32_t>(row));
+}
+
+void TermIndex::OnRowRemoving(size_t row) {
+    // The record may already hold its new text (updates), so remove by the cached terms
+    RemovePostings(static_cast<uint32_t>(row));
+    rowTerms[row].clear();
+}
+
+void TermIndex::OnRowsRemoved(std::span<const uint32_t> rows) {
+    for (uint32_t row : rows) {
+        RemovePostings(row);
+        rowTerms[row].clear();
+    }
+}
+
+void TermIndex::OnRowMoved(size_t from, size_t to) {
+    RemovePostings(static_cast<uint32_t>(from));
+    rowTerms[to] = std::move(rowTerms[from]);
+    rowTerms[from].clear();
+    AddPostings(static_cast<uint32_t>(to));
+}
+
+std::vector<std::wstring> TermIndex::RowTerms(size_t row) {
+    LedgerRow ledgerRow = ledger.Row(row);
+    std::vector<std::wstring> words;
+
+    auto append = [&words](std::wstring_view field) {
+        for (auto& word : SplitWords(field)) words.push_back(std::move(word));
+    };
+
+    if (ledgerRow.IsIncome()) {
+        const Income& income = ledgerRow.GetIncome();
+        append(income.source);
+        append(income.note);
+        for (const auto& tag : income.tags) append(tag);
+    }
+    else {
+        const Expense& expense = ledgerRow.GetExpense();
+        append(expense.category);
+        append(expense.note);
+        for (const auto& tag : expense.tags) append(tag);
+    }
+
+    return words;
+}
+
+// Returns the term's id, adding it to the dictionary if new
+uint32_t TermIndex::Intern(const std::wstring& term) {
+    auto it = termIds.find(term);
+    if (it != termIds.end()) return it->second;
+
+    uint32_t id = static_cast<uint32_t>(terms.size());
+    terms.push_back(term);
+    termRows.emplace_back();
+    termIds.emplace(term, id);
+
+    // A rebuild sorts once at the end
+    if (!rebuilding) {
+        auto position = std::lower_bound(sortedTerms.begin(), sortedTerms.end(), term,
+            [this](uint32_t other, const std::wstring& value) { return terms[other] < value; });
+        sortedTerms.insert(position, id);
+    }
+    return id;
+}
+
+void TermIndex::AddPostings(uint32_t row) {
+    for (uint32_t term : rowTerms[row]) termRows[term].Add(row);
+}
+
+void TermIndex::RemovePostings(uint32_t row) {
+    for (uint32_t term : rowTerms[row]) termRows[term].Remove(row);
+}
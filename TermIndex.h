@@ -0,0 +1,70 @@
+#pragma once
+#include "Ledger.h"
+#include "RowBitmap.h"
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// A row that matched a fuzzy query, with the total edit distance of its
+// closest words (0 when every query word appears exactly)
+struct FuzzyMatch {
+    uint32_t row;
+    uint32_t distance;
+};
+
+// Dictionary of the distinct words in each row's category (source for
+// incomes), note and tags, case-folded, with the rows using each word.
+// Typo-tolerant lookup runs a bounded edit distance over the words in sorted
+// order, skipping every word under a prefix that is already too far from the
+// query, so it only looks at a small part of a large dictionary.
+// Words whose last row goes away stay in the dictionary with no rows until
+// the next rebuild.
+class TermIndex : public LedgerIndex {
+public:
+    // Rows where every word of query is within the allowed edit distance of
+    // one of the row's words, closest first. Short words must match exactly
+    // (see MaxEditDistance).
+    std::vector<FuzzyMatch> FindFuzzy(const std::wstring& query) const;
+
+    // Dictionary words in use within maxDistance edits of word, closest first
+    std::vector<std::wstring> SimilarTerms(std::wstring_view word, uint32_t maxDistance, size_t limit) const;
+
+    size_t TermCount() const { return terms.size(); }
+
+    void OnRebuilt() override;
+    void OnCleared() override;
+    void OnRowAdded(size_t row) override;
+    void OnRowRemoving(size_t row) override;
+    void OnRowsRemoved(std::span<const uint32_t> rows) override;
+    void OnRowMoved(size_t from, size_t to) override;
+
+private:
+    struct TermDistance {
+        uint32_t term;
+        uint32_t distance;
+    };
+
+    static std::vector<std::wstring> RowTerms(size_t row);
+    std::vector<TermDistance> Similar(std::wstring_view word, uint32_t maxDistance) const;
+
+    uint32_t Intern(const std::wstring& term);
+    void AddPostings(uint32_t row);
+    void RemovePostings(uint32_t row);
+
+    std::vector<std::wstring> terms;                    // By term id
+    std::vector<RowBitmap> termRows;                    // By term id
+    std::unordered_map<std::wstring, uint32_t> termIds;
+    std::vector<uint32_t> sortedTerms;                  // Term ids in text order
+    std::vector<std::vector<uint32_t>> rowTerms;        // Term ids by row, kept for removal
+    bool rebuilding = false;                            // Terms are sorted once at the end
+};
+
+extern TermIndex termIndex;
+
+// Lowercased words of text, split on anything that is not a letter or digit
+std::vector<std::wstring> SplitWords(std::wstring_view text);
+
+// Typo allowance for a query word: none up to 3 characters, 1 up to 5, then 2
+uint32_t MaxEditDistance(size_t length);
@@ -0,0 +1,157 @@
+#include "TextIndex.h"
+#include <algorithm>
+#include <cwctype>
+
+TextIndex textIndex;
+
+// Joins fields so a query cannot match across the boundary of two of them
+const wchar_t TEXT_FIELD_SEPARATOR = L'\x1F';
+
+std::wstring FoldText(std::wstring_view text) {
+    std::wstring folded(text);
+    for (auto& ch : folded) ch = static_cast<wchar_t>(std::towlower(ch));
+    return folded;
+}
+
+RowBitmap TextIndex::Find(const std::wstring& text) const {
+    std::wstring folded = FoldText(text);
+    RowBitmap result;
+
+    if (folded.size() < 3) {
+        ledger.ForEachRow([&](size_t row) {
+            if (rowText[row].find(folded) != std::wstring::npos) result.Add(static_cast<uint32_t>(row));
+        });
+        return result;
+    }
+
+    // Intersect from the rarest trigram up
+    std::vector<const RowBitmap*> lists;
+    for (uint64_t trigram : Trigrams(folded)) {
+        auto it = postings.find(trigram);
+        if (it == postings.end()) return result;
+        lists.push_back(&it->second);
+    }
+    std::sort(lists.begin(), lists.end(), [](const RowBitmap* a, const RowBitmap* b) {
+        return a->Cardinality() < b->Cardinality();
+    });
+
+    RowBitmap candidates = *lists[0];
+    for (size_t i = 1; i < lists.size() && !candidates.Empty(); ++i) {
+        candidates &= *lists[i];
+    }
+
+    // Trigrams can all be present without being adjacent
+    candidates.ForEach([&](uint32_t row) {
+        if (rowText[row].find(folded) != std::wstring::npos) result.Add(row);
+    });
+    return result;
+}
+
+size_t TextIndex::EstimateMatches(const std::wstring& text) const {
+    std::wstring folded = FoldText(text);
+    if (folded.size() < 3) return ledger.LiveCount();
+
+    size_t estimate = SIZE_MAX;
+    for (uint64_t trigram : Trigrams(folded)) {
+        auto it = postings.find(trigram);
+        if (it == postings.end()) return 0;
+        estimate = std::min(estimate, it->second.Cardinality());
+    }
+    return estimate;
+}
+
+void TextIndex::OnRebuilt() {
+    OnCleared();
+    rowText.resize(ledger.Size());
+    ledger.ForEachRow([this](size_t row) { OnRowAdded(row); });
+}
+
+void TextIndex::OnCleared() {
+    postings.clear();
+    rowText.clear();
+}
+
+void TextIndex::OnRowAdded(size_t row) {
+    if (rowText.size() <= row) rowText.resize(row + 1);
+    rowText[row] = RowText(row);
+    AddPostings(static_cast<uint32_t>(row));
+}
+
+void TextIndex::OnRowRemoving(size_t row) {
+    // The record may already hold its new text (updates), so remove by the cached text
+    RemovePostings(static_cast<uint32_t>(row));
+    rowText[row].clear();
+}
+
+void TextIndex::OnRowsRemoved(std::span<const uint32_t> rows) {
+    for (uint32_t row : rows) {
+        RemovePostings(row);
+        rowText[row].clear();
+    }
+}
+
+void TextIndex::OnRowMoved(size_t from, size_t to) {
+    RemovePostings(static_cast<uint32_t>(from));
+    rowText[to] = std::move(rowText[from]);
+    rowText[from].clear();
+    AddPostings(static_cast<uint32_t>(to));
+}
+
+std::wstring TextIndex::RowText(size_t row) {
+    LedgerRow ledgerRow = ledger.Row(row);
+    std::wstring text;
+
+    auto append = [&text](std::wstring_view field) {
+        text += field;
+        text += TEXT_FIELD_SEPARATOR;
+    };
+
+    if (ledgerRow.IsIncome()) {
+        const Income& income = ledgerRow.GetIncome();
+        append(income.source);
+        append(income.note);
+        for (const auto& tag : income.tags) append(tag);
+    }
+    else {
+        const Expense& expense = ledgerRow.GetExpense();
+        append(expense.category);
+        append(expense.note);
+        for (const auto& tag : expense.tags) append(tag);
+    }
+
+    return FoldText(text);
+}
+
+// Distinct trigrams, packed 21 bits per character
+std::vector<uint64_t> TextIndex::Trigrams(const std::wstring& folded) {
+    std::vector<uint64_t> trigrams;
+    if (folded.size() < 3) return trigrams;
+
+    trigrams.reserve(folded.size() - 2);
+    for (size_t i = 0; i + 2 < folded.size(); ++i) {
+        uint64_t a = static_cast<uint32_t>(folded[i]) & 0x1FFFFF;
+        uint64_t b = static_cast<uint32_t>(folded[i + 1]) & 0x1FFFFF;
+        uint64_t c = static_cast<uint32_t>(folded[i + 2]) & 0x1FFFFF;
+        trigrams.push_back((a << 42) | (b << 21) | c);
+    }
+
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
+
+void TextIndex::AddPostings(uint32_t row) {
+    for (uint64_t trigram : Trigrams(rowText[row])) {
+        postings[trigram].Add(row);
+    }
+}
+
+void TextIndex::RemovePostings(uint32_t row) {
+    for (uint64_t trigram : Trigrams(rowText[row])) {
+        auto it = postings.find(trigram);
+        if (it == postings.end()) continue;
+
+        it->second.Remove(row);
+        if (it->second.Empty()) postings.erase(it);
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "Ledger.h"
+#include "RowBitmap.h"
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Trigram inverted index over each row's searchable text: category (source
+// for incomes), note and tags, case-folded. A substring query ANDs the
+// posting bitmaps of its trigrams, then verifies the few candidates against
+// the row's cached folded text, so nothing is lowercased per row at query time.
+class TextIndex : public LedgerIndex {
+public:
+    // Rows where the category, note or a tag contains text, ignoring case.
+    // Queries under three characters fall back to checking every row.
+    RowBitmap Find(const std::wstring& text) const;
+
+    // Upper bound on the size of Find(text): the row count of its rarest trigram
+    size_t EstimateMatches(const std::wstring& text) const;
+
+    // Whether the row's text contains folded, which must already be FoldText()ed
+    bool RowContains(uint32_t row, const std::wstring& folded) const {
+        return rowText[row].find(folded) != std::wstring::npos;
+    }
+
+    void OnRebuilt() override;
+    void OnCleared() override;
+    void OnRowAdded(size_t row) override;
+    void OnRowRemoving(size_t row) override;
+    void OnRowsRemoved(std::span<const uint32_t> rows) override;
+    void OnRowMoved(size_t from, size_t to) override;
+
+private:
+    static std::wstring RowText(size_t row);
+    static std::vector<uint64_t> Trigrams(const std::wstring& folded);
+
+    void AddPostings(uint32_t row);
+    void RemovePostings(uint32_t row);
+
+    std::unordered_map<uint64_t, RowBitmap> postings;
+    std::vector<std::wstring> rowText;   // Folded text by row, kept for verification and removal
+};
+
+extern TextIndex textIndex;
+
+// Lowercases every character; the folding used by the text index
+std::wstring FoldText(std::wstring_view text);
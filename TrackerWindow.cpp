@@ -5,6 +5,9 @@
 #include "FinanceManager.h"
 #include "Analytics.h"
 #include "ChartRenderer.h"
+#include "CurrencyManager.h"
+#include "Utils.h"
+#include "Ledger.h"
 #include "resource.h"
 #include <windows.h>
 #include <gdiplus.h>
@@ -90,7 +93,11 @@ LRESULT CALLBACK TrackerWindow::WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam,
         UIManager::CreateStatusBar(hwnd);         // Create the status bar
         UIManager::CreateMainContent(hwnd);  // Create main content area
 
+        AttachLedgerIndexes();
         DatabaseManager::LoadAllData();
+        if (FileExists(RATE_HISTORY_FILE)) {
+            CurrencyManager::LoadRateHistory(RATE_HISTORY_FILE);
+        }
 
 
 
@@ -161,6 +168,10 @@ LRESULT CALLBACK TrackerWindow::WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam,
         }
         return 0;
 
+    case WM_NOTIFY:
+        if (TransactionViewer::HandleListNotify(reinterpret_cast<LPNMHDR>(lParam))) return 0;
+        break;
+
     case WM_SIZE:
     {
         RECT rcClient;
@@ -186,7 +197,12 @@ LRESULT CALLBACK TrackerWindow::WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam,
 
     case WM_TIMER:
         switch (wParam) {
-        case 1: UIManager::RefreshMainContent(hwnd); UIManager::UpdateStatusBar(hwnd); break;
+        case 1:
+            UIManager::RefreshMainContent(hwnd);
+            UIManager::UpdateStatusBar(hwnd);
+            // Idle-time cleanup of deleted rows, bounded so a tick stays short
+            if (ledger.NeedsCompaction()) ledger.Compact(LEDGER_COMPACT_BATCH);
+            break;
         case 2: if (UserManager::IsUserLoggedIn()) BudgetManager::CheckBudgetAlerts(hwnd); break;
         case 3: if (UserManager::IsUserLoggedIn()) RecurringManager::ProcessRecurringTransactions(); break;
         }
@@ -0,0 +1,138 @@
+#include "TransactionPager.h"
+#include "QueryPlanner.h"
+#include <algorithm>
+
+static bool CursorBefore(const TransactionCursor& a, const TransactionCursor& b) {
+    return a.day != b.day ? a.day < b.day : a.seq < b.seq;
+}
+
+TransactionPager::TransactionPager(const FilterCriteria& filter, const std::wstring& user, const TransactionSort& sort)
+    : criteria(filter), userId(user), order(sort), days(ToDayRange(filter.dateRange)) {
+    FilterCriteria defaults;
+    filtered = !criteria.categories.empty() || !criteria.tags.empty() || !criteria.searchText.empty()
+        || criteria.minAmount > defaults.minAmount || criteria.maxAmount < defaults.maxAmount;
+    sorted = order.primary.column != SortColumn::Date || !order.primary.descending
+        || order.secondary.column != SortColumn::Date;
+    Refresh();
+}
+
+void TransactionPager::Refresh() {
+    matches.clear();
+    if (!Materialized()) return;
+
+    std::vector<uint32_t> expenseRows;
+    std::vector<uint32_t> incomeRows;
+    if (filtered) {
+        QueryPlan expensePlan(criteria, userId, false);
+        QueryPlan incomePlan(criteria, userId, true);
+        expenseRows = expensePlan.Execute();
+        incomeRows = incomePlan.Execute();
+    }
+
+    if (sorted) {
+        std::vector<uint64_t> matching;
+        if (filtered) {
+            matching.resize(BitmapWords(ledger.Size()));
+            for (uint32_t row : expenseRows) SetBit(matching, row);
+            for (uint32_t row : incomeRows) SetBit(matching, row);
+        }
+        CollectSorted(matching);
+        return;
+    }
+
+    // Both lists are oldest first; merge them by (day, sequence), then
+    // turn the result newest first
+    matches.reserve(expenseRows.size() + incomeRows.size());
+    for (uint32_t row : expenseRows) matches.push_back(MakeRef(row));
+    size_t middle = matches.size();
+    for (uint32_t row : incomeRows) matches.push_back(MakeRef(row));
+    std::inplace_merge(matches.begin(), matches.begin() + middle, matches.end(),
+        [](const TransactionRef& a, const TransactionRef& b) { return CursorBefore(a.cursor, b.cursor); });
+    std::reverse(matches.begin(), matches.end());
+}
+
+// Keeps the rows of the cached sort permutation that are listed: those in
+// matching for filtered listings, those in the date range otherwise
+void TransactionPager::CollectSorted(std::span<const uint64_t> matching) {
+    SymbolId user = userId.empty() ? ALL_SYMBOLS : SymbolTable::Find(userId);
+    if (!userId.empty() && user == INVALID_SYMBOL) return;
+
+    auto dayColumn = ledger.Days();
+    for (uint32_t row : sortIndex.Order(user, order.primary, order.secondary)) {
+        bool listed = filtered ? TestBit(matching, row) : days.Contains(dayColumn[row]);
+        if (listed) matches.push_back(MakeRef(row));
+    }
+}
+
+size_t TransactionPager::size() const {
+    return Materialized() ? matches.size() : Timeline().size();
+}
+
+std::vector<TransactionRef> TransactionPager::Page(size_t first, size_t count) const {
+    std::vector<TransactionRef> page;
+    size_t total = size();
+    if (first >= total) return page;
+
+    count = std::min(count, total - first);
+    page.reserve(count);
+
+    // The timeline is oldest first: index i is its (total - 1 - i)-th entry
+    auto timeline = Materialized() ? std::span<const TimelineEntry>() : Timeline();
+    for (size_t i = first; i < first + count; ++i) {
+        page.push_back(Materialized() ? matches[i] : MakeRef(timeline[total - 1 - i].row));
+    }
+    return page;
+}
+
+std::vector<TransactionRef> TransactionPager::PageAfter(const TransactionCursor& cursor, size_t count) const {
+    if (!sorted) return Page(CountNewer(cursor, true), count);
+
+    size_t index = IndexOf(cursor);
+    return Page(index < size() ? index + 1 : index, count);
+}
+
+size_t TransactionPager::IndexOf(const TransactionCursor& cursor) const {
+    if (!sorted) return CountNewer(cursor, false);
+
+    // Not in cursor order: look for the row itself
+    auto it = std::find_if(matches.begin(), matches.end(),
+        [&cursor](const TransactionRef& ref) { return ref.cursor.seq == cursor.seq; });
+    return it - matches.begin();
+}
+
+TransactionRef TransactionPager::MakeRef(uint32_t row) {
+    TransactionRef ref;
+    ref.cursor = { ledger.Days()[row], ledger.Sequences()[row] };
+    ref.income = (ledger.Flags()[row] & LEDGER_INCOME) != 0;
+
+    uint32_t slot = ledger.Records()[row];
+    ref.handle = ref.income ? incomes.HandleAt(slot) : expenses.HandleAt(slot);
+    return ref;
+}
+
+// Valid until the next ledger change, so it is looked up again on every call
+std::span<const TimelineEntry> TransactionPager::Timeline() const {
+    return userId.empty() ? ledgerTimeline.Range(days) : userTimeline.Range(SymbolTable::Find(userId), days);
+}
+
+// Rows newer than cursor, plus the row at it when inclusive
+size_t TransactionPager::CountNewer(const TransactionCursor& cursor, bool inclusive) const {
+    auto timeline = Materialized() ? std::span<const TimelineEntry>() : Timeline();
+    size_t total = Materialized() ? matches.size() : timeline.size();
+    auto keyAt = [&](size_t ascending) -> TransactionCursor {
+        if (Materialized()) return matches[total - 1 - ascending].cursor;
+        return { timeline[ascending].day, timeline[ascending].seq };
+    };
+
+    // First ascending position past the cursor
+    size_t low = 0;
+    size_t high = total;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        TransactionCursor key = keyAt(mid);
+        bool past = inclusive ? !CursorBefore(key, cursor) : CursorBefore(cursor, key);
+        if (past) high = mid;
+        else low = mid + 1;
+    }
+    return total - low;
+}
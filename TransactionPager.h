@@ -0,0 +1,78 @@
+#pragma once
+#include "Ledger.h"
+#include "LedgerTimeline.h"
+#include "SortIndex.h"
+#include <span>
+#include <string>
+#include <vector>
+
+// Position in a transaction listing. Listings are ordered newest first by
+// (day, sequence); sequence numbers are unique and never reused, so a cursor
+// names the same place however many rows are added or removed around it.
+struct TransactionCursor {
+    int32_t day;
+    uint32_t seq;
+};
+
+// One listed transaction. The handle survives ledger compaction; resolve it
+// with expenses.Get() / incomes.Get(), which return nullptr once it is deleted.
+struct TransactionRef {
+    TransactionCursor cursor;
+    bool income;
+    SlotHandle handle;
+};
+
+// Sort order of a listing; rows with equal primary keys follow the secondary
+struct TransactionSort {
+    SortKey primary;
+    SortKey secondary;
+};
+
+// Random-access pages over a user's filtered transactions, newest first
+// unless sorted otherwise. Listings filtered only by date read the user's
+// timeline in place, so opening one costs two binary searches whatever the
+// ledger size. Other filters run through the query planner on Refresh(),
+// other orders walk the cached sort permutations; both keep one small key
+// per row, never a copy of the record.
+class TransactionPager {
+public:
+    TransactionPager() = default;
+    TransactionPager(const FilterCriteria& criteria, const std::wstring& userId,
+        const TransactionSort& sort = TransactionSort());
+
+    // Re-runs the filter and sort after ledger changes. Only unsorted date-only
+    // listings read the timeline live and need no refresh; sorted ones are
+    // snapshots like any other.
+    void Refresh();
+
+    size_t size() const;
+
+    // Rows [first, first + count), clamped to the listing
+    std::vector<TransactionRef> Page(size_t first, size_t count) const;
+
+    // Up to count rows after cursor. Inserts and deletes elsewhere in the
+    // listing do not shift it.
+    std::vector<TransactionRef> PageAfter(const TransactionCursor& cursor, size_t count) const;
+
+    // Index of the first row at or after cursor, e.g. to keep a selection
+    // in place across a refresh. In other orders than newest first the
+    // cursor's row must still be listed, otherwise the result is size().
+    size_t IndexOf(const TransactionCursor& cursor) const;
+
+private:
+    static TransactionRef MakeRef(uint32_t row);
+    std::span<const TimelineEntry> Timeline() const;
+    size_t CountNewer(const TransactionCursor& cursor, bool inclusive) const;
+    void CollectSorted(std::span<const uint64_t> matching);
+
+    // The listing lives in matches rather than the timeline
+    bool Materialized() const { return filtered || sorted; }
+
+    FilterCriteria criteria;
+    std::wstring userId;
+    TransactionSort order;
+    DayRange days;
+    bool filtered = false;
+    bool sorted = false;
+    std::vector<TransactionRef> matches;   // Materialized listings only, in listing order
+};
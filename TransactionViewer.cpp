@@ -0,0 +1,158 @@
+#include "FinanceManager.h"
+#include "TransactionPager.h"
+#include <commctrl.h>
+
+// Rows fetched at a time when the list asks for one outside the cache
+const size_t TRANSACTION_PAGE_SIZE = 100;
+
+// The transaction list runs in virtual mode (LVS_OWNERDATA): it holds no
+// items and asks for the text of the rows on screen, which come from the
+// pager a page at a time. Opening or refreshing costs the same for ten rows
+// as for a million.
+static HWND pagedListView = NULL;
+static TransactionPager listPager;
+static FilterCriteria listCriteria;
+static TransactionSort listSort;
+static std::vector<TransactionRef> pageCache;
+static size_t pageCacheFirst = 0;
+
+static const TransactionRef* CachedRow(size_t index) {
+    if (index < pageCacheFirst || index >= pageCacheFirst + pageCache.size()) {
+        pageCacheFirst = index;
+        pageCache = listPager.Page(index, TRANSACTION_PAGE_SIZE);
+    }
+    return index - pageCacheFirst < pageCache.size() ? &pageCache[index - pageCacheFirst] : nullptr;
+}
+
+static std::wstring ColumnText(const TransactionRef& ref, int column) {
+    // Deleted since the last refresh
+    const Expense* expense = ref.income ? nullptr : expenses.Get(ref.handle);
+    const Income* income = ref.income ? incomes.Get(ref.handle) : nullptr;
+    if (!expense && !income) return L"";
+
+    switch (column) {
+    case 0: return std::wstring(expense ? expense->date : income->date);
+    case 1: return expense ? L"Expense" : L"Income";
+    case 2: return std::wstring(expense ? expense->category : income->source);
+    case 3: {
+        wchar_t amountStr[32];
+        swprintf_s(amountStr, L"%.2f", expense ? expense->amount : income->amount);
+        return amountStr;
+    }
+    case 4: return std::wstring(expense ? expense->note : income->note);
+    }
+    return L"";
+}
+
+void TransactionViewer::RefreshTransactionList(HWND hListView, const FilterCriteria& criteria) {
+    if (!hListView) return;
+    if (Header_GetItemCount(ListView_GetHeader(hListView)) == 0) SetupTransactionListView(hListView);
+
+    // Remember the selected transaction by cursor, so it stays selected
+    // when rows are added above it
+    bool hadSelection = false;
+    TransactionCursor selected{};
+    int selectedIndex = ListView_GetNextItem(hListView, -1, LVNI_SELECTED);
+    if (hListView == pagedListView && selectedIndex >= 0) {
+        auto rows = listPager.Page(selectedIndex, 1);
+        if (!rows.empty()) {
+            selected = rows[0].cursor;
+            hadSelection = true;
+        }
+    }
+
+    pagedListView = hListView;
+    listCriteria = criteria;
+    listPager = TransactionPager(criteria, currentUserId, listSort);
+    pageCache.clear();
+    pageCacheFirst = 0;
+
+    ListView_SetItemState(hListView, -1, 0, LVIS_SELECTED | LVIS_FOCUSED);
+    ListView_SetItemCountEx(hListView, static_cast<int>(listPager.size()), LVSICF_NOSCROLL);
+
+    if (hadSelection) {
+        int index = static_cast<int>(listPager.IndexOf(selected));
+        if (index < static_cast<int>(listPager.size())) {
+            ListView_SetItemState(hListView, index, LVIS_SELECTED | LVIS_FOCUSED, LVIS_SELECTED | LVIS_FOCUSED);
+        }
+    }
+
+    InvalidateRect(hListView, NULL, FALSE);
+}
+
+// Clicking a column sorts on it, the previous sort column breaking ties;
+// clicking it again reverses the order. Dates and amounts start largest first.
+static void SortOnColumn(HWND hListView, int column) {
+    SortColumn sortColumn;
+    switch (column) {
+    case 0: sortColumn = SortColumn::Date; break;
+    case 2: sortColumn = SortColumn::Category; break;
+    case 3: sortColumn = SortColumn::Amount; break;
+    case 4: sortColumn = SortColumn::Note; break;
+    default: return;
+    }
+
+    if (listSort.primary.column == sortColumn) {
+        listSort.primary.descending = !listSort.primary.descending;
+    }
+    else {
+        listSort.secondary = listSort.primary;
+        listSort.primary.column = sortColumn;
+        listSort.primary.descending = sortColumn == SortColumn::Date || sortColumn == SortColumn::Amount;
+    }
+
+    // Only a walk over the cached permutation; nothing is re-sorted
+    TransactionViewer::RefreshTransactionList(hListView, listCriteria);
+}
+
+bool TransactionViewer::HandleListNotify(LPNMHDR header) {
+    if (!header || header->hwndFrom != pagedListView) return false;
+
+    switch (header->code) {
+    case LVN_COLUMNCLICK:
+        SortOnColumn(header->hwndFrom, reinterpret_cast<LPNMLISTVIEW>(header)->iSubItem);
+        return true;
+    case LVN_ODCACHEHINT:
+    {
+        // The list announces the rows it is about to draw
+        auto* hint = reinterpret_cast<LPNMLVCACHEHINT>(header);
+        pageCacheFirst = hint->iFrom;
+        pageCache = listPager.Page(hint->iFrom, hint->iTo - hint->iFrom + 1);
+        return true;
+    }
+    case LVN_GETDISPINFO:
+    {
+        auto* info = reinterpret_cast<NMLVDISPINFO*>(header);
+        if (info->item.mask & LVIF_TEXT) {
+            const TransactionRef* row = CachedRow(info->item.iItem);
+            std::wstring text = row ? ColumnText(*row, info->item.iSubItem) : L"";
+            wcsncpy_s(info->item.pszText, info->item.cchTextMax, text.c_str(), _TRUNCATE);
+        }
+        return true;
+    }
+    }
+    return false;
+}
+
+void TransactionViewer::SetupTransactionListView(HWND hListView) {
+    struct Column {
+        const wchar_t* title;
+        int width;
+    };
+    const Column columns[] = {
+        { L"Date", 100 },
+        { L"Type", 70 },
+        { L"Category", 130 },
+        { L"Amount", 90 },
+        { L"Note", 260 }
+    };
+
+    LVCOLUMN column = {};
+    column.mask = LVCF_TEXT | LVCF_WIDTH | LVCF_SUBITEM;
+    for (int i = 0; i < static_cast<int>(std::size(columns)); ++i) {
+        column.pszText = const_cast<LPWSTR>(columns[i].title);
+        column.cx = columns[i].width;
+        column.iSubItem = i;
+        ListView_InsertColumn(hListView, i, &column);
+    }
+}
@@ -11,6 +11,7 @@
 #include "FinanceManager.h"
 #include "Analytics.h"
 #include "ChartRenderer.h"
+#include "LedgerTimeline.h"
 #include "TrackerWindow.h"  // For the menu IDs and control IDs
 #include "resource.h"       // For icon and resource IDs
 
@@ -61,13 +62,6 @@ HWND UIManager::hUserLabel = NULL;
 HWND UIManager::hBalanceLabel = NULL;
 HWND UIManager::hMainToolbar = NULL;
 
-namespace UserDataFilter {
-    // These should be implemented in UserManager.cpp, but declare here if needed:
-    extern double GetUserBalance(const std::wstring& userId);
-    extern double GetUserTotalIncome(const std::wstring& userId);
-    extern double GetUserTotalExpenses(const std::wstring& userId);
-}
-
 namespace UIManagerUtils {
     std::wstring FormatCurrency(double amount) {
         wchar_t buffer[100];
@@ -190,7 +184,7 @@ void UIManager::UpdateStatusBar(HWND hwnd) {
         std::wstring userText = L"User: " + user->displayName;
         SendMessage(hStatusBar, SB_SETTEXT, 1, (LPARAM)userText.c_str());
 
-        double balance = UserDataFilter::GetUserBalance(UserManager::GetCurrentUserId());
+        double balance = Analytics::GetDashboardMetrics(UserManager::GetCurrentUserId()).balance;
         wchar_t balanceText[100];
         swprintf_s(balanceText, L"Balance: $%.2f", balance);
         SendMessage(hStatusBar, SB_SETTEXT, 2, (LPARAM)balanceText);
@@ -234,11 +228,11 @@ void UIManager::CreateMainContent(HWND hwnd) {
     RECT clientRect;
     GetClientRect(hwnd, &clientRect);
 
-    // Create main list view for dashboard
+    // Create main list view for dashboard; virtual, see TransactionViewer
     hMainListView = CreateStyledListView(hwnd, ID_TRANSACTION_LIST,
         SIDEBAR_WIDTH + 20, TOOLBAR_HEIGHT + 20,
         clientRect.right - SIDEBAR_WIDTH - 40,
-        clientRect.bottom - TOOLBAR_HEIGHT - STATUSBAR_HEIGHT - 40);
+        clientRect.bottom - TOOLBAR_HEIGHT - STATUSBAR_HEIGHT - 40, LVS_OWNERDATA);
 
     // Create sidebar
     SidebarManager::CreateSidebar(hwnd);
@@ -323,7 +317,7 @@ void UIManager::RefreshMainContent(HWND hwnd) {
     SetWindowText(hUserLabel, welcomeText.c_str());
 
     // Update balance
-    double balance = UserDataFilter::GetUserBalance(user->username);
+    double balance = Analytics::GetDashboardMetrics(user->username).balance;
     std::wstringstream balanceStream;
     balanceStream << L"Balance: $" << std::fixed << std::setprecision(2) << balance;
     SetWindowText(hBalanceLabel, balanceStream.str().c_str());
@@ -433,18 +427,16 @@ void UIManager::PaintDashboard(HWND hwnd, HDC hdc) {
     // Draw dashboard cards
     std::wstring userId = UserManager::GetCurrentUserId();
 
-    // Quick stats cards
+    // Quick stats cards, from the cache: painting never runs an aggregation
+    DashboardMetrics metrics = Analytics::GetDashboardMetrics(userId);
     std::vector<DashboardCard> cards = {
-        {L"Total Income", Analytics::FormatCurrency(Analytics::GetTotalIncome(userId)),
+        {L"Total Income", Analytics::FormatCurrency(metrics.totalIncome),
          L"This month", COLOR_SUCCESS, L"💰", false, 0.0, nullptr},
-        {L"Total Expenses", Analytics::FormatCurrency(Analytics::GetTotalExpenses(userId)),
+        {L"Total Expenses", Analytics::FormatCurrency(metrics.totalExpenses),
          L"This month", COLOR_DANGER, L"💸", false, 0.0, nullptr},
-        {L"Balance", Analytics::FormatCurrency(Analytics::GetBalance(userId)),
+        {L"Balance", Analytics::FormatCurrency(metrics.balance),
          L"Current", COLOR_PRIMARY, L"🏦", false, 0.0, nullptr},
-        {L"Savings Rate", Analytics::FormatPercentage(
-             Analytics::GetTotalIncome(userId) > 0 ?
-             ((Analytics::GetTotalIncome(userId) - Analytics::GetTotalExpenses(userId)) /
-              Analytics::GetTotalIncome(userId)) * 100 : 0),
+        {L"Savings Rate", Analytics::FormatPercentage(metrics.savingsRate),
          L"This month", COLOR_SUCCESS, L"📈", false, 0.0, nullptr}
     };
 
@@ -562,53 +554,38 @@ void UIManager::DrawRecentTransactions(HDC hdc, RECT rect) {
         return;
     }
 
-    // Get recent transactions
-    std::wstring userId = UserManager::GetCurrentUserId();
-    auto userExpenses = UserDataFilter::GetUserExpenses(userId);
-    auto userIncomes = UserDataFilter::GetUserIncomes(userId);
-
-    // Sort by date (most recent first)
-    std::sort(userExpenses.begin(), userExpenses.end(),
-        [](const Expense& a, const Expense& b) { return a.date > b.date; });
-    std::sort(userIncomes.begin(), userIncomes.end(),
-        [](const Income& a, const Income& b) { return a.date > b.date; });
+    // Walk the user's date-ordered timeline newest first; only the drawn rows are read
+    SymbolId userSymbol = SymbolTable::Find(UserManager::GetCurrentUserId());
+    if (userSymbol == INVALID_SYMBOL) {
+        SelectObject(hdc, oldFont);
+        return;
+    }
 
     int yPos = rect.top + 50;
     int itemHeight = 30;
     int maxItems = (rect.bottom - rect.top - 60) / itemHeight;
     int itemCount = 0;
 
-    // Merge and display recent transactions
-    auto expenseIt = userExpenses.begin();
-    auto incomeIt = userIncomes.begin();
-
-    while ((expenseIt != userExpenses.end() || incomeIt != userIncomes.end()) && itemCount < maxItems) {
-        bool useExpense = true;
-
-        if (expenseIt == userExpenses.end()) {
-            useExpense = false;
-        }
-        else if (incomeIt != userIncomes.end() && incomeIt->date > expenseIt->date) {
-            useExpense = false;
-        }
+    auto timeline = userTimeline.Range(userSymbol, DayRange());
+    for (auto it = timeline.rbegin(); it != timeline.rend() && itemCount < maxItems; ++it) {
+        LedgerRow row = ledger.Row(it->row);
 
         RECT itemRect = { rect.left + 15, yPos, rect.right - 15, yPos + itemHeight };
+        std::wstring name(SymbolTable::Resolve(row.Category()));
 
-        if (useExpense) {
+        if (!row.IsIncome()) {
             // Draw expense
             SetTextColor(hdc, COLOR_DANGER);
-            std::wstring expenseText = expenseIt->category + L" - $" +
-                std::to_wstring((int)expenseIt->amount) + L".00";
+            std::wstring expenseText = name + L" - $" +
+                std::to_wstring((int)row.Amount()) + L".00";
             DrawText(hdc, expenseText.c_str(), -1, &itemRect, DT_LEFT | DT_VCENTER | DT_SINGLELINE);
-            ++expenseIt;
         }
         else {
             // Draw income
             SetTextColor(hdc, COLOR_SUCCESS);
-            std::wstring incomeText = incomeIt->source + L" + $" +
-                std::to_wstring((int)incomeIt->amount) + L".00";
+            std::wstring incomeText = name + L" + $" +
+                std::to_wstring((int)row.Amount()) + L".00";
             DrawText(hdc, incomeText.c_str(), -1, &itemRect, DT_LEFT | DT_VCENTER | DT_SINGLELINE);
-            ++incomeIt;
         }
 
         yPos += itemHeight;
@@ -646,8 +623,9 @@ void UIManager::DrawBudgetOverview(HDC hdc, RECT rect) {
     int itemHeight = 40;
     int maxItems = (rect.bottom - rect.top - 60) / itemHeight;
 
-    for (size_t i = 0; i < userBudgets.size() && i < static_cast<size_t>(maxItems); ++i) {
-        const auto& budget = userBudgets[i];
+    int itemCount = 0;
+    for (const auto& budget : userBudgets) {
+        if (itemCount++ >= maxItems) break;
         if (!budget.isActive) continue;
 
         RECT itemRect = { rect.left + 15, yPos, rect.right - 15, yPos + itemHeight };
@@ -701,9 +679,9 @@ HWND UIManager::CreateStyledCombo(HWND parent, int id, int x, int y, int width,
     return hCombo;
 }
 
-HWND UIManager::CreateStyledListView(HWND parent, int id, int x, int y, int width, int height) {
+HWND UIManager::CreateStyledListView(HWND parent, int id, int x, int y, int width, int height, DWORD style) {
     HWND hListView = CreateWindow(WC_LISTVIEW, L"",
-        WS_VISIBLE | WS_CHILD | WS_BORDER | LVS_REPORT | LVS_SINGLESEL,
+        WS_VISIBLE | WS_CHILD | WS_BORDER | LVS_REPORT | LVS_SINGLESEL | style,
         x, y, width, height, parent, (HMENU)(UINT_PTR)id, GetModuleHandle(NULL), NULL);
 
     StyleListView(hListView);
@@ -935,7 +913,7 @@ void SidebarManager::RefreshSectionContent(HWND hwnd) {
         // Dashboard is handled in PaintDashboard
         break;
     case SidebarSection::TRANSACTIONS:
-        // Populate transaction list
+        TransactionViewer::RefreshTransactionList(UIManager::GetMainListView());
         break;
     case SidebarSection::BUDGET:
         // Show budget overview
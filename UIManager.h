@@ -84,6 +84,7 @@ public:
     static void DrawBudgetOverview(HDC hdc, RECT rect);
 
     // ListView helpers
+    static HWND GetMainListView() { return hMainListView; }
     static void HandleListViewDoubleClick();
     static void HandleListViewColumnClick(LPNMLISTVIEW pnmv);
 
@@ -91,7 +92,7 @@ public:
     static HWND CreateStyledButton(HWND parent, const std::wstring& text, int id, int x, int y, int width, int height);
     static HWND CreateStyledEdit(HWND parent, int id, int x, int y, int width, int height, DWORD style = 0);
     static HWND CreateStyledCombo(HWND parent, int id, int x, int y, int width, int height);
-    static HWND CreateStyledListView(HWND parent, int id, int x, int y, int width, int height);
+    static HWND CreateStyledListView(HWND parent, int id, int x, int y, int width, int height, DWORD style = 0);
     static HWND CreateStyledLabel(HWND parent, const std::wstring& text, int x, int y, int width, int height, COLORREF color = COLOR_TEXT_PRIMARY);
 
     // Common dialogs
@@ -1,6 +1,8 @@
 #include "Utils.h"
 #include "UserManager.h"
 #include "DataStructures.h"
+#include "Ledger.h"
+#include "UserPostings.h"
 #include <sstream>
 
 #include <random>
@@ -88,15 +90,18 @@ bool UserManager::DeleteUser(const std::wstring& username) {
         }
 
         // Remove user data using username (since your structs use userId as wstring)
-        expenses.erase(
-            std::remove_if(expenses.begin(), expenses.end(),
-                [&username](const Expense& e) { return e.userId == username; }),
-            expenses.end());
-
-        incomes.erase(
-            std::remove_if(incomes.begin(), incomes.end(),
-                [&username](const Income& i) { return i.userId == username; }),
-            incomes.end());
+        // Tombstone the ledger rows in one batch, then free the records.
+        // The postings change during removal, so take copies first.
+        SymbolId userSymbol = SymbolTable::Find(username);
+        auto userExpenses = userPostings.ExpenseSlots(userSymbol);
+        auto userIncomes = userPostings.IncomeSlots(userSymbol);
+        std::vector<uint32_t> expenseSlots(userExpenses.begin(), userExpenses.end());
+        std::vector<uint32_t> incomeSlots(userIncomes.begin(), userIncomes.end());
+
+        ledger.RemoveExpenses(expenseSlots);
+        ledger.RemoveIncomes(incomeSlots);
+        expenses.EraseSlots(expenseSlots);
+        incomes.EraseSlots(incomeSlots);
 
         budgets.erase(
             std::remove_if(budgets.begin(), budgets.end(),
@@ -588,72 +593,38 @@ std::wstring UserManager::SimpleHash(const std::wstring& input) {
 
 // UserDataFilter namespace implementation
 namespace UserDataFilter {
-    std::vector<Expense> GetUserExpenses(const std::wstring& userId) {
-        std::vector<Expense> userExpenses;
-        for (const auto& expense : expenses) {
-            if (expense.userId == userId) {
-                userExpenses.push_back(expense);
-            }
-        }
-        return userExpenses;
+    RecordView<Expense> GetUserExpenses(const std::wstring& userId) {
+        return RecordView<Expense>(expenses, userPostings.ExpenseSlots(SymbolTable::Find(userId)));
     }
 
-    std::vector<Income> GetUserIncomes(const std::wstring& userId) {
-        std::vector<Income> userIncomes;
-        for (const auto& income : incomes) {
-            if (income.userId == userId) {
-                userIncomes.push_back(income);
-            }
-        }
-        return userIncomes;
+    RecordView<Income> GetUserIncomes(const std::wstring& userId) {
+        return RecordView<Income>(incomes, userPostings.IncomeSlots(SymbolTable::Find(userId)));
     }
 
-    std::vector<Budget> GetUserBudgets(const std::wstring& userId) {
-        std::vector<Budget> userBudgets;
-        for (const auto& budget : budgets) {
-            if (budget.userId == userId) {
-                userBudgets.push_back(budget);
-            }
-        }
-        return userBudgets;
+    UserFilterView<Budget> GetUserBudgets(const std::wstring& userId) {
+        return UserFilterView<Budget>(budgets, userId);
     }
 
-    std::vector<RecurringTransaction> GetUserRecurringTransactions(const std::wstring& userId) {
-        std::vector<RecurringTransaction> userRecurring;
-        for (const auto& rt : recurringTransactions) {
-            if (rt.userId == userId) {
-                userRecurring.push_back(rt);
-            }
-        }
-        return userRecurring;
+    UserFilterView<RecurringTransaction> GetUserRecurringTransactions(const std::wstring& userId) {
+        return UserFilterView<RecurringTransaction>(recurringTransactions, userId);
     }
 
-    std::vector<SavingsGoal> GetUserSavingsGoals(const std::wstring& userId) {
-        std::vector<SavingsGoal> userGoals;
-        for (const auto& goal : savingsGoals) {
-            if (goal.userId == userId) {
-                userGoals.push_back(goal);
-            }
-        }
-        return userGoals;
+    UserFilterView<SavingsGoal> GetUserSavingsGoals(const std::wstring& userId) {
+        return UserFilterView<SavingsGoal>(savingsGoals, userId);
     }
 
     double GetUserTotalExpenses(const std::wstring& userId) {
         double total = 0.0;
-        for (const auto& expense : expenses) {
-            if (expense.userId == userId) {
-                total += expense.amount;
-            }
+        for (const auto& expense : GetUserExpenses(userId)) {
+            total += expense.amount;
         }
         return total;
     }
 
     double GetUserTotalIncome(const std::wstring& userId) {
         double total = 0.0;
-        for (const auto& income : incomes) {
-            if (income.userId == userId) {
-                total += income.amount;
-            }
+        for (const auto& income : GetUserIncomes(userId)) {
+            total += income.amount;
         }
         return total;
     }
@@ -6,6 +6,7 @@
 #include <chrono>      // For 'now' (if using time functions)
 #include <vector>      // If not already included
 #include <string>      // If not already included
+#include <string_view>
 
 
 // Dialog IDs for user management
@@ -80,13 +81,60 @@ private:
     static std::wstring SimpleHash(const std::wstring& input);
 };
 
-// Utility functions for user data filtering
+// One user's entries of a small global vector (budgets, goals...), filtered
+// while iterating. Copies nothing; the vector and userId must outlive the view.
+template <typename T>
+class UserFilterView {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        Iterator() : current(nullptr), last(nullptr) {}
+        Iterator(const T* first, const T* end, std::wstring_view user)
+            : current(first), last(end), userId(user) { SkipOthers(); }
+
+        reference operator*() const { return *current; }
+        pointer operator->() const { return current; }
+        Iterator& operator++() { ++current; SkipOthers(); return *this; }
+        Iterator operator++(int) { Iterator old = *this; ++*this; return old; }
+        bool operator==(const Iterator& other) const { return current == other.current; }
+
+    private:
+        void SkipOthers() {
+            while (current != last && current->userId != userId) ++current;
+        }
+
+        const T* current;
+        const T* last;
+        std::wstring_view userId;
+    };
+
+    UserFilterView(const std::vector<T>& source, std::wstring_view user)
+        : first(source.data()), last(source.data() + source.size()), userId(user) {}
+
+    Iterator begin() const { return Iterator(first, last, userId); }
+    Iterator end() const { return Iterator(last, last, userId); }
+    bool empty() const { return begin() == end(); }
+
+private:
+    const T* first;
+    const T* last;
+    std::wstring_view userId;
+};
+
+// Utility functions for user data filtering. The results are views over the
+// global containers, valid until those containers next change.
 namespace UserDataFilter {
-    std::vector<Expense> GetUserExpenses(const std::wstring& userId);
-    std::vector<Income> GetUserIncomes(const std::wstring& userId);
-    std::vector<Budget> GetUserBudgets(const std::wstring& userId);
-    std::vector<RecurringTransaction> GetUserRecurringTransactions(const std::wstring& userId);
-    std::vector<SavingsGoal> GetUserSavingsGoals(const std::wstring& userId);
+    RecordView<Expense> GetUserExpenses(const std::wstring& userId);
+    RecordView<Income> GetUserIncomes(const std::wstring& userId);
+    UserFilterView<Budget> GetUserBudgets(const std::wstring& userId);
+    UserFilterView<RecurringTransaction> GetUserRecurringTransactions(const std::wstring& userId);
+    UserFilterView<SavingsGoal> GetUserSavingsGoals(const std::wstring& userId);
 
     double GetUserTotalExpenses(const std::wstring& userId);
     double GetUserTotalIncome(const std::wstring& userId);
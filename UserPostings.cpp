@@ -0,0 +1,69 @@
+#include "UserPostings.h"
+
+UserPostings userPostings;
+
+std::span<const uint32_t> UserPostings::ExpenseSlots(SymbolId user) const {
+    auto it = byUser.find(user);
+    if (it == byUser.end()) return {};
+    return it->second.expenseSlots;
+}
+
+std::span<const uint32_t> UserPostings::IncomeSlots(SymbolId user) const {
+    auto it = byUser.find(user);
+    if (it == byUser.end()) return {};
+    return it->second.incomeSlots;
+}
+
+void UserPostings::OnRebuilt() {
+    OnCleared();
+    expensePositions.resize(expenses.SlotCount());
+    incomePositions.resize(incomes.SlotCount());
+    ledger.ForEachRow([this](size_t row) { OnRowAdded(row); });
+}
+
+void UserPostings::OnCleared() {
+    byUser.clear();
+    expensePositions.clear();
+    incomePositions.clear();
+}
+
+void UserPostings::OnRowAdded(size_t row) {
+    bool isIncome = (ledger.Flags()[row] & LEDGER_INCOME) != 0;
+    uint32_t slot = ledger.Records()[row];
+    Postings& postings = byUser[ledger.Users()[row]];
+
+    auto& slots = isIncome ? postings.incomeSlots : postings.expenseSlots;
+    auto& positions = isIncome ? incomePositions : expensePositions;
+    if (positions.size() <= slot) positions.resize(slot + 1);
+
+    positions[slot] = static_cast<uint32_t>(slots.size());
+    slots.push_back(slot);
+}
+
+void UserPostings::OnRowRemoving(size_t row) {
+    Remove(row);
+}
+
+void UserPostings::OnRowsRemoved(std::span<const uint32_t> rows) {
+    for (uint32_t row : rows) Remove(row);
+}
+
+void UserPostings::OnRowMoved(size_t, size_t) {
+    // Postings hold store slots, which do not change when rows move
+}
+
+void UserPostings::Remove(size_t row) {
+    auto it = byUser.find(ledger.Users()[row]);
+    if (it == byUser.end()) return;
+
+    bool isIncome = (ledger.Flags()[row] & LEDGER_INCOME) != 0;
+    uint32_t slot = ledger.Records()[row];
+    auto& slots = isIncome ? it->second.incomeSlots : it->second.expenseSlots;
+    auto& positions = isIncome ? incomePositions : expensePositions;
+
+    uint32_t position = positions[slot];
+    uint32_t moved = slots.back();
+    slots[position] = moved;
+    positions[moved] = position;
+    slots.pop_back();
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "Ledger.h"
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+// Per-user postings lists: the store slots of each user's expenses and
+// incomes. Reading one user's records costs that user's record count,
+// not a scan of every record. List order is unspecified.
+class UserPostings : public LedgerIndex {
+public:
+    // Valid until the next change to the ledger
+    std::span<const uint32_t> ExpenseSlots(SymbolId user) const;
+    std::span<const uint32_t> IncomeSlots(SymbolId user) const;
+
+    void OnRebuilt() override;
+    void OnCleared() override;
+    void OnRowAdded(size_t row) override;
+    void OnRowRemoving(size_t row) override;
+    void OnRowsRemoved(std::span<const uint32_t> rows) override;
+    void OnRowMoved(size_t from, size_t to) override;
+
+private:
+    struct Postings {
+        std::vector<uint32_t> expenseSlots;
+        std::vector<uint32_t> incomeSlots;
+    };
+
+    void Remove(size_t row);
+
+    std::unordered_map<SymbolId, Postings> byUser;
+
+    // Slot -> position in its user's list, so removal is a swap with the last entry
+    std::vector<uint32_t> expensePositions;
+    std::vector<uint32_t> incomePositions;
+};
+
+extern UserPostings userPostings;
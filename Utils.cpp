@@ -2,6 +2,7 @@
 #include "Utils.h"
 #include "DataStructures.h"
 #include "UIManager.h"
+#include "CurrencyManager.h"
 #include <chrono>
 #include <random>
 #include <sstream>
@@ -41,20 +42,8 @@ CurrencyType StringToCurrency(const std::wstring& currencyString) {
 }
 
 double ConvertCurrency(double amount, CurrencyType from, CurrencyType to) {
-    // Enhanced currency conversion with more rates
-    if (from == to) return amount;
-
-    // Stub implementation - you'd normally get exchange rates from an API
-    std::map<CurrencyType, double> rates = {
-        {CurrencyType::USD, 1.0},
-        {CurrencyType::EUR, 0.85},
-        {CurrencyType::GBP, 0.73},
-        {CurrencyType::JPY, 110.0},
-        {CurrencyType::CAD, 1.25},
-        {CurrencyType::AUD, 1.35}
-    };
-
-    return (amount / rates[from]) * rates[to];
+    // Dense rate matrix lookup; see CurrencyManager
+    return amount * CurrencyManager::Rate(from, to);
 }
 
 // =============================================================================
@@ -187,6 +176,72 @@ bool IsDateInRange(const std::wstring& date, const DateRange& range) {
     return date >= range.startDate && date <= range.endDate;
 }
 
+// Days from civil date (proleptic Gregorian), March-based year
+static int CivilToDayNumber(int year, int month, int day) {
+    year -= month <= 2 ? 1 : 0;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yearOfEra = year - era * 400;
+    int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+int DateToDayNumber(std::wstring_view date) {
+    if (date.size() < 10 || date[4] != L'-' || date[7] != L'-') return INVALID_DAY;
+
+    int fields[3] = { 0, 0, 0 };
+    const size_t starts[3] = { 0, 5, 8 };
+    const size_t lengths[3] = { 4, 2, 2 };
+    for (int f = 0; f < 3; ++f) {
+        for (size_t i = starts[f]; i < starts[f] + lengths[f]; ++i) {
+            if (date[i] < L'0' || date[i] > L'9') return INVALID_DAY;
+            fields[f] = fields[f] * 10 + (date[i] - L'0');
+        }
+    }
+
+    int year = fields[0];
+    int month = fields[1];
+    int day = fields[2];
+    if (month < 1 || month > 12 || day < 1 || day > 31) return INVALID_DAY;
+
+    return CivilToDayNumber(year, month, day);
+}
+
+int DayNumberToMonthIndex(int dayNumber) {
+    // Civil date from days, only the year and month are needed
+    int z = dayNumber + 719468;
+    int era = (z >= 0 ? z : z - 146096) / 146097;
+    int dayOfEra = z - era * 146097;
+    int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int mp = (5 * dayOfYear + 2) / 153;
+    int month = mp < 10 ? mp + 3 : mp - 9;
+    int year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+    return year * 12 + (month - 1);
+}
+
+int MonthIndexToDayNumber(int monthIndex) {
+    return CivilToDayNumber(monthIndex / 12, monthIndex % 12 + 1, 1);
+}
+
+std::wstring MonthIndexToKey(int monthIndex) {
+    wchar_t key[16];
+    swprintf_s(key, L"%04d-%02d", monthIndex / 12, monthIndex % 12 + 1);
+    return key;
+}
+
+int MonthIndexToMidDay(int monthIndex) {
+    return MonthIndexToDayNumber(monthIndex) + 14;
+}
+
+int CurrentMonthIndex() {
+    auto time_t = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+
+    std::tm tm;
+    localtime_s(&tm, &time_t);
+    return (tm.tm_year + 1900) * 12 + tm.tm_mon;
+}
+
 // =============================================================================
 // DATA INITIALIZATION
 // =============================================================================
@@ -197,19 +252,8 @@ void InitializeDefaultData() {
         categories.push_back(defaultCat);
     }
 
-    // Initialize exchange rates (simplified - in real app, fetch from API)
-    exchangeRates[CurrencyType::USD][CurrencyType::EUR] = 0.85;
-    exchangeRates[CurrencyType::USD][CurrencyType::GBP] = 0.73;
-    exchangeRates[CurrencyType::USD][CurrencyType::JPY] = 110.0;
-    exchangeRates[CurrencyType::USD][CurrencyType::CAD] = 1.25;
-    exchangeRates[CurrencyType::USD][CurrencyType::AUD] = 1.35;
-
-    // Reverse rates
-    for (auto& fromCurrency : exchangeRates) {
-        for (auto& toCurrency : fromCurrency.second) {
-            exchangeRates[toCurrency.first][fromCurrency.first] = 1.0 / toCurrency.second;
-        }
-    }
+    // Initialize exchange rates
+    CurrencyManager::SetUsdRates(DEFAULT_USD_RATES);
 }
 
 // =============================================================================
@@ -224,6 +268,47 @@ std::vector<std::wstring> ParseTags(const std::wstring& tagsString) {
     return Split(tagsString, L',');
 }
 
+std::string WStringToString(std::wstring_view wstr) {
+    if (wstr.empty()) return std::string();
+
+    // Ids, dates and codes are plain ASCII: narrow them directly instead of
+    // making the two WideCharToMultiByte passes
+    if (std::all_of(wstr.begin(), wstr.end(), [](wchar_t c) { return c < 0x80; })) {
+        std::string ascii(wstr.size(), '\0');
+        for (size_t i = 0; i < wstr.size(); ++i) ascii[i] = static_cast<char>(wstr[i]);
+        return ascii;
+    }
+
+    int size_needed = WideCharToMultiByte(CP_UTF8, 0, wstr.data(), (int)wstr.size(), NULL, 0, NULL, NULL);
+    std::string strTo(size_needed, 0);
+    WideCharToMultiByte(CP_UTF8, 0, wstr.data(), (int)wstr.size(), &strTo[0], size_needed, NULL, NULL);
+    return strTo;
+}
+
+std::wstring StringToWString(const std::string& str) {
+    if (str.empty()) return std::wstring();
+
+    if (std::all_of(str.begin(), str.end(), [](char c) { return static_cast<unsigned char>(c) < 0x80; })) {
+        return std::wstring(str.begin(), str.end());
+    }
+
+    int size_needed = MultiByteToWideChar(CP_UTF8, 0, &str[0], (int)str.size(), NULL, 0);
+    std::wstring wstrTo(size_needed, 0);
+    MultiByteToWideChar(CP_UTF8, 0, &str[0], (int)str.size(), &wstrTo[0], size_needed);
+    return wstrTo;
+}
+
+void StringToWString(const std::string& str, RecordString& out) {
+    if (std::all_of(str.begin(), str.end(), [](char c) { return static_cast<unsigned char>(c) < 0x80; })) {
+        out.assign(str.begin(), str.end());
+        return;
+    }
+
+    int size_needed = MultiByteToWideChar(CP_UTF8, 0, str.data(), (int)str.size(), NULL, 0);
+    out.resize(size_needed);
+    MultiByteToWideChar(CP_UTF8, 0, str.data(), (int)str.size(), out.data(), size_needed);
+}
+
 // =============================================================================
 // BUDGET AND SPENDING
 // =============================================================================
@@ -7,6 +7,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <climits>
 
 // =============================================================================
 // CURRENCY UTILITIES
@@ -45,6 +46,15 @@ bool ValidateUser(const User& user);
 // =============================================================================
 bool IsDateInRange(const std::wstring& date, const DateRange& range);
 
+// Day numbers are days since 1970-01-01 and order the same way as the date strings
+const int INVALID_DAY = INT_MIN;
+int DateToDayNumber(std::wstring_view date);         // "YYYY-MM-DD[...]" -> day number or INVALID_DAY
+int DayNumberToMonthIndex(int dayNumber);            // year * 12 + (month - 1)
+int MonthIndexToDayNumber(int monthIndex);           // First day of the month
+std::wstring MonthIndexToKey(int monthIndex);        // -> "YYYY-MM"
+int MonthIndexToMidDay(int monthIndex);              // The 15th, whose rates value a whole month
+int CurrentMonthIndex();                             // Month index of today, local time
+
 // =============================================================================
 // DATA INITIALIZATION
 // =============================================================================
@@ -55,6 +65,11 @@ bool IsDateInRange(const std::wstring& date, const DateRange& range);
 std::wstring TagsToString(const std::vector<std::wstring>& tags);
 std::vector<std::wstring> ParseTags(const std::wstring& tagsString);
 
+// UTF-16 <-> UTF-8 for persistence; the in-memory model stays UTF-16 for Win32
+std::string WStringToString(std::wstring_view wstr);
+std::wstring StringToWString(const std::string& str);
+void StringToWString(const std::string& str, RecordString& out);   // Into out's own memory resource
+
 // =============================================================================
 // BUDGET AND SPENDING
 // =============================================================================
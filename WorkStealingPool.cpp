@@ -0,0 +1,94 @@
+#include "WorkStealingPool.h"
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(unsigned threadCount) {
+    if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned i = 0; i < threadCount; ++i) workers.push_back(std::make_unique<Worker>());
+    for (unsigned i = 0; i < threadCount; ++i) threads.emplace_back(&WorkStealingPool::WorkerLoop, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> guard(stateLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& thread : threads) thread.join();
+}
+
+void WorkStealingPool::Run(std::vector<std::function<void()>>& tasks) {
+    if (tasks.empty()) return;
+
+    // Set before dealing: a worker still draining the last batch may pick
+    // up a new task as soon as it is in a deque
+    {
+        std::lock_guard<std::mutex> guard(stateLock);
+        pending = tasks.size();
+        error = nullptr;
+    }
+
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        Worker& worker = *workers[i % workers.size()];
+        std::lock_guard<std::mutex> guard(worker.lock);
+        // Owners pop from the back, so the first dealt is the first run
+        worker.tasks.push_front(&tasks[i]);
+    }
+
+    std::unique_lock<std::mutex> lock(stateLock);
+    ++batch;
+    wake.notify_all();
+    finished.wait(lock, [this] { return pending == 0; });
+
+    if (error) std::rethrow_exception(error);
+}
+
+void WorkStealingPool::WorkerLoop(unsigned index) {
+    unsigned seenBatch = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(stateLock);
+            wake.wait(lock, [&] { return stopping || batch != seenBatch; });
+            if (stopping) return;
+            seenBatch = batch;
+        }
+
+        while (Task* task = TakeTask(index)) {
+            std::exception_ptr thrown;
+            try {
+                (*task)();
+            }
+            catch (...) {
+                thrown = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> guard(stateLock);
+            if (thrown && !error) error = thrown;
+            if (--pending == 0) finished.notify_all();
+        }
+    }
+}
+
+WorkStealingPool::Task* WorkStealingPool::TakeTask(unsigned index) {
+    {
+        Worker& own = *workers[index];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty()) {
+            Task* task = own.tasks.back();
+            own.tasks.pop_back();
+            return task;
+        }
+    }
+
+    // Steal the task its owner would run last
+    for (size_t offset = 1; offset < workers.size(); ++offset) {
+        Worker& victim = *workers[(index + offset) % workers.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            Task* task = victim.tasks.front();
+            victim.tasks.pop_front();
+            return task;
+        }
+    }
+    return nullptr;
+}
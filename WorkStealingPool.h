@@ -0,0 +1,51 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads, each with its own task deque. A worker takes
+// tasks from the back of its own deque and, once that is empty, steals from
+// the front of the others', so uneven tasks even out without every worker
+// contending on one shared queue.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned threadCount = 0);   // 0: one per hardware thread
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    unsigned ThreadCount() const { return static_cast<unsigned>(threads.size()); }
+
+    // Runs every task and returns once all have finished. Tasks are dealt to
+    // the workers round-robin in order, so put the largest first. The first
+    // exception a task throws is rethrown here after the rest have run.
+    void Run(std::vector<std::function<void()>>& tasks);
+
+private:
+    using Task = std::function<void()>;
+
+    struct Worker {
+        std::mutex lock;
+        std::deque<Task*> tasks;
+    };
+
+    void WorkerLoop(unsigned index);
+    Task* TakeTask(unsigned index);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    std::mutex stateLock;
+    std::condition_variable wake;       // A batch was dealt, or the pool is stopping
+    std::condition_variable finished;   // The last task of a batch completed
+    size_t pending = 0;
+    unsigned batch = 0;
+    bool stopping = false;
+    std::exception_ptr error;
+};